@@ -0,0 +1,124 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iterator>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "search/PolyglotBook.h"
+#include "moves/MoveValidator.h"
+#include "moves/MoveExecutor.h"
+#include "constants/Constants.h"
+using namespace std;
+
+const int TIMED_PROBES = 100000;
+
+// Move sequences and the keys the Polyglot specification gives for them
+struct PublishedKey {
+    const char* moves;
+    uint64_t key;
+};
+
+const PublishedKey PUBLISHED_KEYS[] = {
+    { "", 0x463B96181691FC9CULL },
+    { "e2e4", 0x823C9B50FD114196ULL },
+    { "e2e4 d7d5", 0x0756B94461C50FB0ULL },
+    { "e2e4 d7d5 e4e5", 0x662FAFB965DB29D4ULL },
+    { "e2e4 d7d5 e4e5 f7f5", 0x22A48B5A8E47FF78ULL },
+    { "e2e4 d7d5 e4e5 f7f5 e1e2", 0x652A607CA3F242C1ULL },
+    { "e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00FDD303C946BDD9ULL },
+    { "a2a4 b7b5 h2h4 b5b4 c2c4", 0x3C8123EA7B067637ULL },
+    { "a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5C3F9B829B279560ULL }
+};
+
+void printUsage() {
+    cout << "Usage: book <book.bin> [move ...]" << endl;
+    cout << "       book --check" << endl;
+    cout << "Maps a Polyglot book and probes it after the optional moves in coordinate" << endl;
+    cout << "notation. --check compares the keys computed here with the ones published" << endl;
+    cout << "in the Polyglot specification." << endl;
+}
+
+// Plays moves in coordinate notation, false at the first illegal one
+bool applyMoves(Board& board, char* moveTexts[], int count) {
+    MoveValidator validator(&board);
+    MoveExecutor executor(&board, &validator);
+    for (int i = 0; i < count; i++) {
+        Move move = Move::fromString(moveTexts[i]);
+        MoveList legalMoves;
+        validator.getLegalMoves(legalMoves);
+        if (!legalMoves.contains(move)) {
+            cerr << "Illegal move: " << moveTexts[i] << endl;
+            return false;
+        }
+        executor.makeMove(move);
+    }
+    return true;
+}
+
+string keyToString(uint64_t key) {
+    char text[17];
+    snprintf(text, sizeof(text), "%016llx", (unsigned long long)key);
+    return text;
+}
+
+int checkPublishedKeys() {
+    int failures = 0;
+    for (const PublishedKey& published : PUBLISHED_KEYS) {
+        istringstream input(published.moves);
+        vector<string> words{ istream_iterator<string>(input), istream_iterator<string>() };
+        vector<char*> moveTexts;
+        for (string& word : words) {
+            moveTexts.push_back(&word[0]);
+        }
+        Board board(BOARD_HEIGHT, BOARD_WIDTH);
+        bool played = applyMoves(board, moveTexts.data(), (int)moveTexts.size());
+        uint64_t key = PolyglotBook::computeKey(board);
+        bool ok = played && key == published.key;
+        failures += !ok;
+        cout << keyToString(key) << ((ok) ? " ok   " : " FAIL ") << ((*published.moves) ? published.moves : "start position") << endl;
+    }
+    return (failures) ? 1 : 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    if (strcmp(argv[1], "--check") == 0) {
+        return checkPublishedKeys();
+    }
+    PolyglotBook book;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (!book.open(argv[1])) {
+        cerr << "Cannot map " << argv[1] << endl;
+        return 1;
+    }
+    double openSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    Board board(BOARD_HEIGHT, BOARD_WIDTH);
+    if (!applyMoves(board, argv + 2, argc - 2)) {
+        return 1;
+    }
+
+    Move best, weighted;
+    bool found = book.probe(board, best, BookSelection::BEST);
+    book.probe(board, weighted, BookSelection::WEIGHTED);
+
+    start = chrono::steady_clock::now();
+    long long hits = 0;
+    for (int i = 0; i < TIMED_PROBES; i++) {
+        hits += book.probe(board, weighted, BookSelection::WEIGHTED);
+    }
+    double probeSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Entries: " << book.getEntryCount() << endl;
+    cout << "Open time: " << openSeconds * 1000 << " ms" << endl;
+    cout << "Key: " << keyToString(book.computeKey(board)) << endl;
+    cout << "Best move: " << ((found) ? best.toString() : "none") << endl;
+    cout << "Weighted pick: " << ((found) ? weighted.toString() : "none") << endl;
+    cout << "Probe time: " << probeSeconds / TIMED_PROBES * 1e6 << " us" << endl;
+    return (hits) ? 0 : 2;
+}
@@ -5,16 +5,25 @@
 #include <cctype>
 #include <thread>
 #include <chrono>
-#define NOMINMAX
-#include "windows.h"
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstring>
 #include "GameManager.h"
 #include "pieces/ChessPieceBuilder.h"
 #include "constants/Constants.h"
 #include "constants/Enums.h"
-#include "fcntl.h"
-#include "io.h"
 using namespace std;
 
+// Shared by the event loop and the render thread. The lock is held while the
+// game is changed or drawn.
+struct FrameSignal {
+    mutex lock;
+    condition_variable changed;
+    bool dirty = true; // the screen no longer shows the game
+    bool closing = false;
+};
+
 const vector<ChessPiece> standardPromotionPieces = ChessPieceFactory::createStandardPromotionPieces();
 
 void loadSound(sf::SoundBuffer& buffer, string fileName) {
@@ -46,56 +55,72 @@ void setPlaceHolderPieces(vector<Cell>& v, PieceSide promoSide = PieceSide::NONE
     }
 }
 
-void runGame(sf::Event& event, GameState& gameState, int& winnerSide, int& move, sf::RenderWindow& window, 
-    GameManager& board, ostringstream& titleStr, sf::Text& titleText, WindowState& windowState, sf::Text& buttonText, 
-    vector<Cell>& promoCells, bool& holderPiecesSet) {
-    bool promote = board.isDoPromotion();
-    if (promote && !holderPiecesSet) {
-        setPlaceHolderPieces(promoCells, board.getPromotionSide());
-        holderPiecesSet = true;
+// Counts a played move and ends the game on checkmate or stalemate
+void endTurn(GameState curState, GameState& gameState, int& winnerSide, int& move, WindowState& windowState, sf::Text& buttonText) {
+    if (curState != GameState::NO_TURN) {
+        move += 1;
+        gameState = curState;
+        if (gameState == GameState::CHECKMATE) {
+            winnerSide = (move - 1) % 2;
+        }
     }
-    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-        int yAdj = event.mouseButton.y - Y_OFFSET;
-        int selectedPos = NONE_SELECTED;
-        if (promote) {
-            for (int i = 0; i < promoCells.size() && selectedPos == NONE_SELECTED; i++) {
-                if (promoCells.at(i).getRect().getGlobalBounds().contains(event.mouseButton.x, event.mouseButton.y)) {
-                    selectedPos = i;
-                }
-            }
-            if (selectedPos != NONE_SELECTED) {
-                board.setPromotedPiece(promoCells.at(selectedPos));
-                holderPiecesSet = false;
+    if (gameState == GameState::CHECKMATE || gameState == GameState::STALEMATE) {
+        buttonText.setString("Play Again?");
+        windowState = WindowState::END;
+    }
+}
+
+// Applies a click to the game
+void runGame(sf::Event& event, GameState& gameState, int& winnerSide, int& move, GameManager& board,
+    WindowState& windowState, sf::Text& buttonText, vector<Cell>& promoCells, bool& holderPiecesSet) {
+    bool promote = board.isDoPromotion();
+    int yAdj = event.mouseButton.y - Y_OFFSET;
+    int selectedPos = NONE_SELECTED;
+    GameState curState = GameState::NO_TURN;
+    if (promote) {
+        for (int i = 0; i < promoCells.size() && selectedPos == NONE_SELECTED; i++) {
+            if (promoCells.at(i).getRect().getGlobalBounds().contains(event.mouseButton.x, event.mouseButton.y)) {
+                selectedPos = i;
             }
         }
-        else if (inBoardRange(event.mouseButton.x, yAdj)) {
-            int boardPos = (event.mouseButton.x / CELL_WIDTH) + (yAdj / CELL_WIDTH) * BOARD_WIDTH;
-            GameState curState = board.selectTile(boardPos, move);
-            if (curState != GameState::NO_TURN) {
-                move += 1;
-                gameState = curState;
-                if (gameState == GameState::CHECKMATE) {
-                    winnerSide = (move - 1) % 2;
-                }
-            }
+        if (selectedPos != NONE_SELECTED) {
+            curState = board.setPromotedPiece(promoCells.at(selectedPos));
+            holderPiecesSet = false;
         }
     }
-    switch (gameState) {
-    case GameState::CHECK:
-    case GameState::NONE:
-        window.clear((gameState == GameState::CHECK) ? sf::Color::Red : sf::Color::Black);
-        window.draw(board);
-        if (promote) {
-            for (Cell& c : promoCells) {
-                window.draw(c);
-            }
+    else if (inBoardRange(event.mouseButton.x, yAdj)) {
+        int boardPos = (event.mouseButton.x / CELL_WIDTH) + (yAdj / CELL_WIDTH) * BOARD_WIDTH;
+        curState = board.selectTile(boardPos, move);
+    }
+    // The promotion choices are shown as soon as a pawn reaches the last rank
+    if (board.isDoPromotion() && !holderPiecesSet) {
+        setPlaceHolderPieces(promoCells, board.getPromotionSide());
+        holderPiecesSet = true;
+    }
+    endTurn(curState, gameState, winnerSide, move, windowState, buttonText);
+}
+
+// The engine's move for the side to move, from the opening book or by searching.
+// Only reads the game, so it runs without the frame lock.
+Move findEngineMove(GameManager& board) {
+    SearchLimits limits;
+    limits.maxSeconds = ENGINE_MOVE_SECONDS;
+    return board.getBestMove(limits);
+}
+
+void playEngineMove(const Move& best, GameState& gameState, int& winnerSide, int& move, GameManager& board, WindowState& windowState, sf::Text& buttonText) {
+    if (best.isValid()) {
+        endTurn(board.playMove(best, move), gameState, winnerSide, move, windowState, buttonText);
+    }
+}
+
+void drawGame(sf::RenderWindow& window, GameState gameState, const GameManager& board, const vector<Cell>& promoCells) {
+    window.clear((gameState == GameState::CHECK) ? sf::Color::Red : sf::Color::Black);
+    window.draw(board);
+    if (board.isDoPromotion()) {
+        for (const Cell& c : promoCells) {
+            window.draw(c);
         }
-        break;
-    case GameState::CHECKMATE:
-    case GameState::STALEMATE:
-        buttonText.setString("Play Again?");
-        windowState = WindowState::END;
-        break;
     }
 }
 
@@ -107,6 +132,9 @@ void displayTitleText(sf::RenderWindow& window, GameState& gameState, sf::Text&
     case GameState::NONE:
     case GameState::NO_TURN:
     case GameState::CHECK:
+    case GameState::TABLEBASE_WIN:
+    case GameState::TABLEBASE_DRAW:
+    case GameState::TABLEBASE_LOSS:
         text = "2-P Chess!";
         break;
     case GameState::CHECKMATE:
@@ -121,8 +149,35 @@ void displayTitleText(sf::RenderWindow& window, GameState& gameState, sf::Text&
     window.draw(titleText);
 }
 
-void resetGame(GameManager& board, int& move, int& winnerSide, GameState& gameState, WindowState& windowState, sf::Sound& sound, sf::Font& font) {
-    board = GameManager(BOARD_WIDTH, BOARD_HEIGHT, sound, font);
+// Draws a frame whenever the event loop marks the screen dirty, at most maxFps
+// times a second (0 leaves the pace to vsync alone). Changes made while a
+// frame waits for its turn are drawn together in it.
+void renderLoop(sf::RenderWindow& window, FrameSignal& frames, int maxFps, const function<void()>& drawFrame) {
+    window.setActive(true);
+    chrono::steady_clock::duration frameTime = (maxFps > 0) ? chrono::steady_clock::duration(chrono::seconds(1)) / maxFps : chrono::steady_clock::duration::zero();
+    chrono::steady_clock::time_point nextFrame = chrono::steady_clock::now();
+    while (true) {
+        {
+            unique_lock<mutex> guard(frames.lock);
+            frames.changed.wait(guard, [&]() { return frames.dirty || frames.closing; });
+        }
+        this_thread::sleep_until(nextFrame);
+        {
+            lock_guard<mutex> guard(frames.lock);
+            if (frames.closing) {
+                break;
+            }
+            frames.dirty = false;
+            drawFrame();
+        }
+        window.display(); // waits for vsync without holding up the event loop
+        nextFrame = chrono::steady_clock::now() + frameTime;
+    }
+    window.setActive(false);
+}
+
+void resetGame(GameManager& board, int& move, int& winnerSide, GameState& gameState, WindowState& windowState) {
+    board.reset();
     move = 0;
     winnerSide = -1;
     gameState = GameState::NONE;
@@ -138,7 +193,13 @@ void setupButton(sf::RectangleShape& rect, sf::Vector2f size, sf::Vector2f pos,
     buttonText.setPosition(rect.getPosition() + (rect.getSize() / 2.f));
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    int maxFps = DEFAULT_MAX_FPS;
+    for (int arg = 1; arg + 1 < argc; arg += 2) {
+        if (strcmp(argv[arg], "--fps") == 0) {
+            maxFps = max(atoi(argv[arg + 1]), 0);
+        }
+    }
     int move = 0, winnerSide = -1;
     vector<Cell> promotionCells(4);
     bool holderPiecesSet = false, winSoundPlayed = false;
@@ -150,7 +211,6 @@ int main() {
     sf::Text titleText;
     sf::Text buttonText;
     sf::RectangleShape replayButton;
-    ostringstream titleStr;
     sf::Music music;
     music.openFromFile(AUDIO_PATH + "music.mp3");
     music.setLoop(true);
@@ -177,52 +237,98 @@ int main() {
         cur.setDefaultColor(sf::Color::Cyan);
     }
 
-    while (window.isOpen()) {
-
-        sf::Event event;
+    // Drawing happens on its own thread, only after something changed, so the
+    // window costs nothing while nobody touches it
+    FrameSignal frames;
+    function<void()> drawFrame = [&]() {
+        switch (windowState) {
+        case WindowState::START:
+        case WindowState::END:
+            displayTitleText(window, gameState, titleText, winnerSide);
+            window.draw(replayButton);
+            window.draw(buttonText);
+            break;
+        case WindowState::GAME:
+            drawGame(window, gameState, board, promotionCells);
+            break;
+        }
+    };
+    window.setActive(false);
+    thread renderThread([&]() { renderLoop(window, frames, maxFps, drawFrame); });
 
-        while (window.pollEvent(event)) {
+    function<void()> playEndSound = [&]() {
+        if (windowState == WindowState::END && !winSoundPlayed) {
+            winSound.play();
+            music.stop();
+            winSoundPlayed = true;
+        }
+    };
 
-            if (event.type == sf::Event::Closed)
-                window.close();
+    // Events are waited for, not polled, and must be read on the thread that made the window
+    sf::Event event;
+    while (window.waitEvent(event)) {
+        if (event.type == sf::Event::Closed) {
+            break;
+        }
+        bool click = event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left;
+        bool engineMove = event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Space;
+        bool redraw = click || engineMove || event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus;
+        if (!redraw) {
+            continue; // mouse moves and the like change nothing on screen
+        }
+        bool searchMove = false;
+        {
+            lock_guard<mutex> guard(frames.lock);
+            bool onButton = click && replayButton.getGlobalBounds().contains(event.mouseButton.x, event.mouseButton.y);
             switch (windowState) {
             case WindowState::START:
-                displayTitleText(window, gameState, titleText, winnerSide);
-                window.draw(replayButton);
-                window.draw(buttonText);
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    if (replayButton.getGlobalBounds().contains(event.mouseButton.x, event.mouseButton.y)) {
-                        windowState = WindowState::GAME;
-                        selectSound.play();
-                        music.play();
-                    }
+                if (onButton) {
+                    windowState = WindowState::GAME;
+                    selectSound.play();
+                    music.play();
                 }
                 break;
             case WindowState::GAME:
-                runGame(event, gameState, winnerSide, move, window, board, titleStr, titleText, 
-                    windowState, buttonText, promotionCells, holderPiecesSet);
+                if (click) {
+                    runGame(event, gameState, winnerSide, move, board, windowState, buttonText, promotionCells, holderPiecesSet);
+                }
+                else if (engineMove) {
+                    searchMove = !board.isDoPromotion(); // the player has a piece to pick first
+                }
+                playEndSound();
                 break;
             case WindowState::END:
-                displayTitleText(window, gameState, titleText, winnerSide);
-                if (!winSoundPlayed) {
-                    winSound.play();
-                    music.stop();
-                    winSoundPlayed = true;
-                }
-                window.draw(replayButton);
-                window.draw(buttonText);
-                if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                    if (replayButton.getGlobalBounds().contains(event.mouseButton.x, event.mouseButton.y)) {
-                        resetGame(board, move, winnerSide, gameState, windowState, moveSound, font);
-                        selectSound.play();
-                        music.play();
-                        winSoundPlayed = false;
-                    }
+                if (onButton) {
+                    resetGame(board, move, winnerSide, gameState, windowState);
+                    selectSound.play();
+                    music.play();
+                    winSoundPlayed = false;
                 }
+                break;
             }
-            window.display();
+            frames.dirty = true;
+        }
+        frames.changed.notify_one();
+
+        // Only this thread changes the game and the render thread only reads
+        // it, so the search runs unlocked and the window keeps being drawn
+        if (searchMove) {
+            Move best = findEngineMove(board);
+            {
+                lock_guard<mutex> guard(frames.lock);
+                playEngineMove(best, gameState, winnerSide, move, board, windowState, buttonText);
+                playEndSound();
+                frames.dirty = true;
+            }
+            frames.changed.notify_one();
         }
     }
 
+    {
+        lock_guard<mutex> guard(frames.lock);
+        frames.closing = true;
+    }
+    frames.changed.notify_one();
+    renderThread.join();
+    window.close();
 }
-
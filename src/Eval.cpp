@@ -0,0 +1,160 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "moves/MoveValidator.h"
+#include "moves/MoveExecutor.h"
+#include "search/Evaluation.h"
+#include "search/Nnue.h"
+#include "constants/Constants.h"
+using namespace std;
+
+const uint64_t RANDOM_NETWORK_SEED = 1;
+
+void printUsage() {
+    cout << "Usage: eval <depth> [--fen fen] [--nnue file|random] [--simd scalar|sse4.1|avx2]" << endl;
+    cout << "Prints the evaluation of the start position or --fen, then walks every move" << endl;
+    cout << "path of the given depth and evaluates each leaf, once with the sums the board" << endl;
+    cout << "keeps as pieces move and once by summing every piece from scratch. Reports" << endl;
+    cout << "evaluations/sec for both, including the moves made to reach the leaves, and" << endl;
+    cout << "checks that they agree." << endl;
+    cout << "With --nnue the network is timed the same way, updating its accumulators move" << endl;
+    cout << "by move against refreshing them at every leaf, for each SIMD kernel the CPU" << endl;
+    cout << "runs or only the one given with --simd. \"random\" uses random weights." << endl;
+}
+
+// Plays every path to the given depth, calling beforeMove(move, ply) before each
+// move and atLeaf(ply) at the leaves
+template <typename BeforeMove, typename AtLeaf>
+void walk(MoveValidator& validator, MoveExecutor& executor, int depth, int ply, BeforeMove& beforeMove, AtLeaf& atLeaf) {
+    MoveList moves;
+    validator.getLegalMoves(moves);
+    for (const Move& move : moves) {
+        beforeMove(move, ply);
+        executor.makeMove(move);
+        if (depth == 1) {
+            atLeaf(ply + 1);
+        }
+        else {
+            walk(validator, executor, depth - 1, ply + 1, beforeMove, atLeaf);
+        }
+        executor.unmakeMove();
+    }
+}
+
+// Times one walk and prints the evaluation rate. Returns the sum of the
+// evaluations, which keeps the walk from being optimized away.
+template <typename BeforeMove, typename Evaluate>
+long long benchmark(const string& name, MoveValidator& validator, MoveExecutor& executor, int depth, BeforeMove beforeMove, Evaluate evaluate) {
+    long long leaves = 0, sum = 0;
+    auto atLeaf = [&](int ply) {
+        sum += evaluate(ply);
+        leaves++;
+    };
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    walk(validator, executor, depth, 0, beforeMove, atLeaf);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << name << ": " << leaves << " leaves, " << seconds << " s, evaluations/sec " << (long long)(leaves / max(seconds, 1e-9))
+        << ", sum " << sum << endl;
+    return sum;
+}
+
+// Leaves where the two evaluations differ
+template <typename BeforeMove, typename EvaluateA, typename EvaluateB>
+long long countMismatches(MoveValidator& validator, MoveExecutor& executor, int depth, BeforeMove beforeMove, EvaluateA first, EvaluateB second) {
+    long long mismatches = 0;
+    auto atLeaf = [&](int ply) {
+        mismatches += first(ply) != second(ply);
+    };
+    walk(validator, executor, depth, 0, beforeMove, atLeaf);
+    return mismatches;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || atoi(argv[1]) < 1) {
+        printUsage();
+        return 1;
+    }
+    int depth = atoi(argv[1]);
+    string fen = START_FEN, network;
+    vector<SimdMode> simdModes = { SimdMode::SCALAR, SimdMode::SSE41, SimdMode::AVX2 };
+    for (int arg = 2; arg < argc; arg++) {
+        if (strcmp(argv[arg], "--fen") == 0 && arg + 1 < argc) {
+            fen = argv[++arg];
+        }
+        else if (strcmp(argv[arg], "--nnue") == 0 && arg + 1 < argc) {
+            network = argv[++arg];
+        }
+        else if (strcmp(argv[arg], "--simd") == 0 && arg + 1 < argc) {
+            string mode = argv[++arg];
+            simdModes.assign(1, (mode == "avx2") ? SimdMode::AVX2 : (mode == "sse4.1") ? SimdMode::SSE41 : SimdMode::SCALAR);
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    Board board(BOARD_HEIGHT, BOARD_WIDTH);
+    if (!board.fromFEN(fen)) {
+        cerr << "Invalid FEN: " << fen << endl;
+        return 1;
+    }
+    MoveValidator validator(&board);
+    MoveExecutor executor(&board, &validator);
+    cout << "Position: " << fen << endl;
+    cout << "Evaluation: " << Evaluation::evaluate(board) << " cp for the side to move" << endl;
+
+    auto noUpdate = [](const Move&, int) {};
+    auto evaluateIncremental = [&](int) { return Evaluation::evaluate(board); };
+    auto evaluateFromScratch = [&](int) { return Evaluation::evaluateFromScratch(board); };
+    benchmark("Incremental", validator, executor, depth, noUpdate, evaluateIncremental);
+    benchmark("From scratch", validator, executor, depth, noUpdate, evaluateFromScratch);
+    long long mismatches = countMismatches(validator, executor, depth, noUpdate, evaluateIncremental, evaluateFromScratch);
+    cout << "Mismatches: " << mismatches << endl;
+    if (network.empty()) {
+        return (mismatches == 0) ? 0 : 1;
+    }
+
+    if (network == "random") {
+        Nnue::randomize(RANDOM_NETWORK_SEED);
+    }
+    else if (!Nnue::load(network)) {
+        cerr << "Cannot load network " << network << endl;
+        return 1;
+    }
+    vector<NnueAccumulator> accumulators(depth + 1);
+    NnueAccumulator refreshed;
+    auto update = [&](const Move& move, int ply) { Nnue::update(board, move, accumulators[ply], accumulators[ply + 1]); };
+    auto evaluateUpdated = [&](int ply) { return Nnue::evaluate(accumulators[ply], board.getSideToMove()); };
+    auto evaluateRefreshed = [&](int) {
+        Nnue::refresh(board, refreshed);
+        return Nnue::evaluate(refreshed, board.getSideToMove());
+    };
+
+    // Every kernel must give the same evaluations, updated or refreshed
+    const char* simdNames[] = { "scalar", "sse4.1", "avx2" };
+    long long nnueMismatches = 0, firstSum = 0;
+    bool first = true;
+    for (SimdMode requested : simdModes) {
+        if (Nnue::setSimdMode(requested) != requested) {
+            cout << "NNUE " << simdNames[(int)requested] << ": not supported by this CPU" << endl;
+            continue;
+        }
+        Nnue::refresh(board, accumulators[0]);
+        if (first) {
+            cout << "NNUE evaluation: " << Nnue::evaluate(accumulators[0], board.getSideToMove()) << " cp for the side to move" << endl;
+        }
+        string name = string("NNUE ") + simdNames[(int)requested];
+        long long updated = benchmark(name + " incremental", validator, executor, depth, update, evaluateUpdated);
+        long long full = benchmark(name + " full refresh", validator, executor, depth, noUpdate, evaluateRefreshed);
+        nnueMismatches += countMismatches(validator, executor, depth, update, evaluateUpdated, evaluateRefreshed);
+        nnueMismatches += (updated != full) + (!first && updated != firstSum);
+        firstSum = (first) ? updated : firstSum;
+        first = false;
+    }
+    cout << "NNUE mismatches: " << nnueMismatches << endl;
+    return (mismatches == 0 && nnueMismatches == 0) ? 0 : 1;
+}
@@ -5,9 +5,11 @@
 #include "moves/MoveExecutor.h"
 #include "moves/MoveValidator.h"
 #include "board/BoardRenderer.h"
+#include "search/Search.h"
+#include "search/Evaluation.h"
+#include "search/PolyglotBook.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
-#include <set>
 
 class GameManager : public sf::Drawable {
 private:
@@ -15,19 +17,93 @@ private:
     MoveValidator validator;
     BoardRenderer renderer;
     MoveExecutor executor;
+    sf::Sound* moveSound;
     int selected;
-    set<int> currentValidMoves;
+    MoveList currentValidMoves;
+    TranspositionTable table;
+    PolyglotBook book;
+    vector<uint64_t> gameHistory; // hashes of the positions before state since the last capture or pawn move
+
+    // Remembers the position a move is about to leave, see Search::setGameHistory
+    void recordPosition() {
+        gameHistory.push_back(state.getHash());
+    }
+
+    // Nothing before a capture or pawn move can come back
+    void afterMove() {
+        if (state.getHalfmoveClock() == 0) {
+            gameHistory.clear();
+        }
+    }
+
+    void clearSelection() {
+        renderer.toggleCellSelected(selected);
+        selected = NONE_SELECTED;
+        renderer.highlightValidMoves(currentValidMoves); // This will toggle off the highlights
+        currentValidMoves.clear();
+    }
+
+    // Shows the evaluation of the position from each side's point of view
+    void updateEvaluationText() {
+        int white = Evaluation::evaluate(state) * ((state.getSideToMove() == PieceSide::WHITE) ? 1 : -1);
+        renderer.updateScoreText(0, white);
+        renderer.updateScoreText(1, -white);
+    }
 
 public:
     GameManager(int h, int w, sf::Sound& sound, sf::Font& textFont) 
-        : state(h, w, sound), 
+        : state(h, w), 
           validator(&state), 
           renderer(&state, textFont), 
-          executor(&state, &validator, sound) {
+          executor(&state, &validator),
+          moveSound(&sound),
+          table(DEFAULT_HASH_MEGABYTES) {
+        selected = NONE_SELECTED;
+        // The book is optional, without it every move is searched
+        book.open(BOOK_PATH + "book.bin");
+    }
+
+    // Starts a new game in place, the validator, executor and renderer keep pointing at this board
+    void reset() {
+        state = Board(state.getHeight(), state.getWidth());
+        executor = MoveExecutor(&state, &validator);
+        updateEvaluationText();
         selected = NONE_SELECTED;
+        currentValidMoves.clear();
+        table.clear();
+        gameHistory.clear();
+    }
+
+    // Plays from the opening book while it has the position, otherwise searches
+    // a copy of the current position, which sees repetitions of the earlier game
+    // positions. The board itself is left untouched.
+    Move getBestMove(const SearchLimits& limits) {
+        Move bookMove;
+        if (book.probe(state, bookMove)) {
+            return bookMove;
+        }
+        table.newSearch();
+        Search search(state, table);
+        search.setGameHistory(gameHistory);
+        return search.run(limits).bestMove;
     }
 
-    // Called when a tile is clicked on in the GUI
+    // Plays a move chosen by getBestMove, a promotion goes straight to its piece
+    GameState playMove(const Move& move, int moveNum) {
+        if (selected != NONE_SELECTED) {
+            clearSelection();
+        }
+        executor.setCurrentMoveNumber(moveNum);
+        recordPosition();
+        GameState turnState = executor.executeMove(move.from, move.to, move.promotion);
+        afterMove();
+        moveSound->play();
+        updateEvaluationText();
+        return turnState;
+    }
+
+    // Called when a tile is clicked on in the GUI. A pawn reaching the last
+    // rank returns NO_TURN, the turn ends with setPromotedPiece.
     GameState selectTile(int pos, int moveNum) {
         int turn = moveNum % 2;
         PieceSide activeSide = turn == 0 ? PieceSide::WHITE : PieceSide::BLACK;
@@ -36,28 +112,25 @@ public:
         
         if (selected == NONE_SELECTED) {
             // Try to select a piece
-            ChessPiece& curPiece = state.getCell(pos).getChessPiece();
+            ChessPiece& curPiece = state.getPiece(pos);
             if (curPiece.isActive() && curPiece.getSide() == activeSide) {
                 selected = pos;
-                currentValidMoves = validator.getPossibleMoves(selected, curPiece, true, curPiece);
+                currentValidMoves = validator.getPossibleMoves(selected, true);
                 renderer.highlightValidMoves(currentValidMoves, curPiece.getSide());
                 renderer.toggleCellSelected(selected);
             }
         } else {
             // Attempt to move the selected piece
-            if (selected != pos && currentValidMoves.find(pos) != currentValidMoves.end()) {
+            if (selected != pos && currentValidMoves.containsTarget(pos)) {
+                recordPosition();
                 turnState = executor.executeMove(selected, pos);
-                
-                // Update score display
-                const vector<int>& scores = state.getScores();
-                renderer.updateScoreText(turn, scores.at(turn));
+                afterMove();
+                moveSound->play();
+                updateEvaluationText();
             }
             
             // Deselect the piece regardless of move validity
-            renderer.toggleCellSelected(selected);
-            selected = NONE_SELECTED;
-            renderer.highlightValidMoves(currentValidMoves); // This will toggle off the highlights
-            currentValidMoves.clear();
+            clearSelection();
         }
         
         return turnState;
@@ -75,7 +148,10 @@ public:
         return executor.getPromotionSide();
     }
     
-    void setPromotedPiece(Cell& cell) {
-        executor.setPromotedPiece(cell);
+    // Completes the move that is waiting for its promotion piece
+    GameState setPromotedPiece(Cell& cell) {
+        GameState turnState = executor.setPromotedPiece(cell.getChessPiece());
+        updateEvaluationText();
+        return turnState;
     }
 };
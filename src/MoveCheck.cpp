@@ -0,0 +1,287 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "moves/MoveValidator.h"
+#include "moves/MoveExecutor.h"
+#include "search/Tablebase.h"
+#include "util/WorkStealingPool.h"
+#include "util/LatencyHistogram.h"
+#include "constants/Constants.h"
+using namespace std;
+
+const int DEFAULT_BATCH_LINES = 1024;
+const int LINES_PER_TASK = 64;
+
+void printUsage() {
+    cout << "Usage: movecheck [-t threads] [--batch lines] [--tablebase paths]" << endl;
+    cout << "       movecheck --check [--tablebase paths]" << endl;
+    cout << "Reads one request per line from stdin and answers each on stdout in the same order:" << endl;
+    cout << "  <fen> ; <move>   -> ok <state> <resulting fen> | illegal <reason>" << endl;
+    cout << "  <fen>            -> moves <state> <count> <move> ..." << endl;
+    cout << "A malformed FEN or an impossible position is answered with illegal position." << endl;
+    cout << "States are none, check, checkmate and stalemate for the side to move, or with" << endl;
+    cout << "--tablebase tbwin, tbdraw and tbloss when the Syzygy tables cover it. Paths are" << endl;
+    cout << "directories separated by ':' (';' on Windows)." << endl;
+    cout << "Requests are read and answered a batch at a time (default 1024 lines), use" << endl;
+    cout << "--batch 1 when a client waits for each answer before sending the next request." << endl;
+    cout << "Throughput and p50/p99 times go to stderr: service time to compute one answer," << endl;
+    cout << "and latency from reading a request to its answer being ready, which includes" << endl;
+    cout << "waiting for the rest of its batch to be read and for earlier batches." << endl;
+    cout << "--check answers a built-in set of requests and compares with the expected answers," << endl;
+    cout << "with --tablebase it also probes known KQvK and KPvK positions in the given tables." << endl;
+}
+
+const char* stateName(GameState state) {
+    switch (state) {
+        case GameState::CHECK: return "check";
+        case GameState::CHECKMATE: return "checkmate";
+        case GameState::STALEMATE: return "stalemate";
+        case GameState::TABLEBASE_WIN: return "tbwin";
+        case GameState::TABLEBASE_DRAW: return "tbdraw";
+        case GameState::TABLEBASE_LOSS: return "tbloss";
+        default: return "none";
+    }
+}
+
+// A result proven by the tablebase replaces NONE or CHECK. Wins and losses
+// the fifty move rule spoils count as draws.
+GameState withTablebase(GameState state, Board& board, const MoveValidator& validator, MoveExecutor& executor) {
+    int wdl;
+    if ((state != GameState::NONE && state != GameState::CHECK) || !Tablebase::probeWdl(board, validator, executor, wdl)) {
+        return state;
+    }
+    return (wdl == Tablebase::WIN) ? GameState::TABLEBASE_WIN : (wdl == Tablebase::LOSS) ? GameState::TABLEBASE_LOSS : GameState::TABLEBASE_DRAW;
+}
+
+// Board and rules owned by one worker thread, reused for every request it answers
+struct CheckContext {
+    Board board;
+    MoveValidator validator;
+    MoveExecutor executor;
+
+    CheckContext() : board(BOARD_HEIGHT, BOARD_WIDTH), validator(&board), executor(&board, &validator) {}
+
+    // Writes the answer to one request line into out
+    void answer(string& line, string& out) {
+        size_t separator = line.find(';');
+        size_t fenEnd = (separator == string::npos) ? line.size() : separator;
+        while (fenEnd > 0 && (line[fenEnd - 1] == ' ' || line[fenEnd - 1] == '\r')) {
+            fenEnd--;
+        }
+        if (separator != string::npos) {
+            line[fenEnd] = '\0'; // the FEN ends where the move begins
+        }
+        else {
+            line.resize(fenEnd);
+        }
+        executor.clearHistory();
+        // Malformed records and impossible positions alike
+        if (!board.fromFEN(line.c_str())) {
+            out = "illegal position";
+            return;
+        }
+        PieceSide side = board.getSideToMove();
+
+        if (separator == string::npos) {
+            MoveList moves;
+            validator.getLegalMoves(moves);
+            out = "moves ";
+            out += stateName(withTablebase(validator.check(oppositeSide(side), true), board, validator, executor));
+            out += ' ' + to_string(moves.size());
+            for (const Move& move : moves) {
+                out += ' ' + move.toString();
+            }
+            return;
+        }
+
+        size_t moveStart = line.find_first_not_of(' ', separator + 1);
+        size_t moveEnd = line.find_first_of(" \r", moveStart);
+        Move move = (moveStart == string::npos) ? Move() : Move::fromString(line.substr(moveStart, moveEnd - moveStart));
+        if (!move.isValid()) {
+            out = "illegal malformed move";
+            return;
+        }
+        ChessPiece& piece = board.getPiece(move.from);
+        if (!piece.isOnSide(side)) {
+            out = "illegal no piece of the side to move";
+            return;
+        }
+        if (!validator.getPossibleMoves(move.from, true).containsTarget(move.to)) {
+            out = "illegal move";
+            return;
+        }
+        if (validator.shouldPromote(piece, move.to) != (move.promotion != PieceType::EMPTY)) {
+            out = (move.promotion == PieceType::EMPTY) ? "illegal missing promotion" : "illegal promotion";
+            return;
+        }
+        executor.makeMove(move);
+        out = "ok ";
+        out += stateName(withTablebase(validator.check(side, true), board, validator, executor));
+        out += ' ' + board.toFEN();
+    }
+};
+
+struct CheckedRequest {
+    const char* line;
+    const char* answer;
+};
+
+// Answers that must not change, run by --check
+const CheckedRequest CHECKED_REQUESTS[] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 ; e2e4", "ok none rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1" },
+    { "k7/8/1Q6/8/8/8/8/K7 w - - 0 1 ; b6b7", "ok check k7/1Q6/8/8/8/8/8/K7 b - - 1 1" },
+    { "4k3/8/8/8/8/8/8/4RK2 b - - 0 1 ; e8e7", "illegal move" },
+    { "4k3/8/8/8/8/8/8/4RK2 w - - 0 1 ; e1e8", "illegal position" }, // would capture the king
+    { "4k3/8/8/8/8/8/8/4RK2 w - - 0 1", "illegal position" },
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq", "illegal position" },
+};
+
+// A win whose distance to zeroing depends on the tables' tie breaks
+const int ANY_WINNING_DTZ = 0x7FFF;
+
+struct CheckedProbe {
+    const char* fen;
+    int wdl;
+    int dtz;
+};
+
+// Results every set of Syzygy files must give, checked by --check with --tablebase
+const CheckedProbe CHECKED_PROBES[] = {
+    { "8/8/8/4k3/8/8/8/KQ6 w - - 0 1", Tablebase::WIN, ANY_WINNING_DTZ },
+    { "k7/8/1K6/8/8/8/8/7Q w - - 0 1", Tablebase::WIN, 1 }, // Qh8#
+    { "k6Q/8/1K6/8/8/8/8/8 b - - 0 1", Tablebase::LOSS, -1 }, // mated
+    { "8/8/8/8/8/8/1k6/Q3K3 b - - 0 1", Tablebase::DRAW, 0 }, // Kxa1
+    { "4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", Tablebase::DRAW, 0 }, // stalemate
+    { "8/4P3/8/8/8/k7/8/K7 w - - 0 1", Tablebase::WIN, 1 }, // e8=Q
+    { "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", Tablebase::WIN, ANY_WINNING_DTZ },
+};
+
+int checkAnswers(bool tablebase) {
+    CheckContext context;
+    int failures = 0;
+    for (const CheckedRequest& request : CHECKED_REQUESTS) {
+        string line = request.line, out;
+        context.answer(line, out);
+        bool ok = out == request.answer;
+        failures += !ok;
+        cout << ((ok) ? "ok   " : "FAIL ") << request.line << " -> " << out << endl;
+    }
+    if (!tablebase) {
+        return (failures) ? 1 : 0;
+    }
+    if (Tablebase::getMaxPieces() < 3) {
+        cout << "FAIL no KQvK and KPvK tables" << endl;
+        return 1;
+    }
+    for (const CheckedProbe& probe : CHECKED_PROBES) {
+        context.board.fromFEN(probe.fen);
+        int wdl = -3, dtz = 0;
+        bool ok = Tablebase::probeWdl(context.board, context.validator, context.executor, wdl) && wdl == probe.wdl
+            && Tablebase::probeDtz(context.board, context.validator, context.executor, dtz)
+            && ((probe.dtz == ANY_WINNING_DTZ) ? dtz > 0 : dtz == probe.dtz);
+        failures += !ok;
+        cout << ((ok) ? "ok   " : "FAIL ") << probe.fen << " -> wdl " << wdl << " dtz " << dtz << endl;
+    }
+    return (failures) ? 1 : 0;
+}
+
+// Requests read together, answered on the pool and written in input order
+struct Batch {
+    vector<string> lines;
+    vector<string> answers;
+    vector<chrono::steady_clock::time_point> readTimes;
+    vector<chrono::steady_clock::time_point> startTimes; // when a worker took the request
+    vector<chrono::steady_clock::time_point> answerTimes; // when its answer was ready
+    int count = 0;
+
+    Batch(int capacity) : lines(capacity), answers(capacity), readTimes(capacity), startTimes(capacity), answerTimes(capacity) {}
+
+    bool read(int capacity) {
+        count = 0;
+        while (count < capacity && getline(cin, lines[count])) {
+            readTimes[count++] = chrono::steady_clock::now();
+        }
+        return count > 0;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    int threads = max((int)thread::hardware_concurrency(), 1);
+    int batchLines = DEFAULT_BATCH_LINES;
+    bool check = false, tablebase = false;
+    for (int arg = 1; arg < argc; arg++) {
+        bool hasValue = arg + 1 < argc;
+        if (strcmp(argv[arg], "--check") == 0) {
+            check = true;
+        }
+        else if (hasValue && strcmp(argv[arg], "-t") == 0) {
+            threads = max(atoi(argv[++arg]), 1);
+        }
+        else if (hasValue && strcmp(argv[arg], "--batch") == 0) {
+            batchLines = max(atoi(argv[++arg]), 1);
+        }
+        else if (hasValue && strcmp(argv[arg], "--tablebase") == 0) {
+            tablebase = true;
+            if (!Tablebase::setPaths(argv[++arg])) {
+                cerr << "No Syzygy tables in " << argv[arg] << endl;
+            }
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (check) {
+        return checkAnswers(tablebase);
+    }
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+
+    WorkStealingPool pool(threads);
+    vector<unique_ptr<CheckContext>> contexts;
+    for (int i = 0; i < threads; i++) {
+        contexts.emplace_back(new CheckContext());
+    }
+
+    // The next batch is read while the pool answers the current one
+    Batch batches[2] = { Batch(batchLines), Batch(batchLines) };
+    LatencyHistogram serviceTime, latency;
+    long long requests = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool more = batches[0].read(batchLines);
+    for (int current = 0; more; current ^= 1) {
+        Batch& batch = batches[current];
+        for (int first = 0; first < batch.count; first += LINES_PER_TASK) {
+            int last = min(first + LINES_PER_TASK, batch.count);
+            pool.submit([&, first, last](int worker) {
+                for (int i = first; i < last; i++) {
+                    batch.startTimes[i] = chrono::steady_clock::now();
+                    contexts[worker]->answer(batch.lines[i], batch.answers[i]);
+                    batch.answerTimes[i] = chrono::steady_clock::now();
+                }
+            });
+        }
+        more = batches[current ^ 1].read(batchLines);
+        pool.waitIdle();
+
+        for (int i = 0; i < batch.count; i++) {
+            cout << batch.answers[i] << '\n';
+            serviceTime.add(chrono::duration_cast<chrono::nanoseconds>(batch.answerTimes[i] - batch.startTimes[i]).count());
+            latency.add(chrono::duration_cast<chrono::nanoseconds>(batch.answerTimes[i] - batch.readTimes[i]).count());
+        }
+        cout.flush();
+        requests += batch.count;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cerr << "Requests: " << requests << endl;
+    cerr << "Threads: " << threads << endl;
+    cerr << "Time: " << seconds << " s" << endl;
+    cerr << "Requests/sec: " << (long long)(requests / max(seconds, 1e-9)) << endl;
+    cerr << "Service time p50: " << serviceTime.percentile(0.5) / 1000 << " us, p99: " << serviceTime.percentile(0.99) / 1000 << " us" << endl;
+    cerr << "Latency p50: " << latency.percentile(0.5) / 1000 << " us, p99: " << latency.percentile(0.99) / 1000 << " us (batches of " << batchLines << ")" << endl;
+    return 0;
+}
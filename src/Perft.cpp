@@ -0,0 +1,226 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include "moves/Perft.h"
+#include "moves/ParallelPerft.h"
+#include "util/AllocationCounter.h"
+#include <cstring>
+#include "constants/Constants.h"
+using namespace std;
+
+void printUsage() {
+    cout << "Usage: perft <depth> [-t threads] [--split plies] [--hash megabytes] [--sliders rays|magic|pext] [--fen fen] [move ...]" << endl;
+    cout << "       perft <depth> --epd file" << endl;
+    cout << "Counts legal move paths of the given depth from the start position or --fen," << endl;
+    cout << "after playing the optional moves in coordinate notation (e.g. e2e4 e7e5)." << endl;
+    cout << "With -t the tree is split into tasks of the given plies (default 2) and" << endl;
+    cout << "counted on a work-stealing pool. --hash reuses counts of transposed subtrees." << endl;
+    cout << "--sliders picks how bishop and rook attacks are looked up (default pext in" << endl;
+    cout << "builds for BMI2, magic otherwise). pext is an error in other builds." << endl;
+    cout << "--epd checks every \";D<depth> <count>\" entry up to the given depth for each" << endl;
+    cout << "position in the file, one FEN per line." << endl;
+}
+
+// Streams an EPD suite one line at a time, the board and line buffer are reused
+int checkSuite(const char* path, int maxDepth, PerftCache* cache) {
+    ifstream file(path);
+    if (!file) {
+        cerr << "Cannot open " << path << endl;
+        return 1;
+    }
+    Board board(BOARD_HEIGHT, BOARD_WIDTH);
+    Perft perft(&board, cache);
+    string line;
+    line.reserve(256);
+    long long positions = 0, checks = 0, failures = 0, nodes = 0;
+    double parseSeconds = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int lineNumber = 1; getline(file, line); lineNumber++) {
+        size_t opcodes = line.find(';');
+        size_t fenEnd = (opcodes == string::npos) ? line.size() : opcodes;
+        while (fenEnd > 0 && line[fenEnd - 1] == ' ') {
+            fenEnd--;
+        }
+        if (fenEnd == 0) {
+            continue;
+        }
+        line[fenEnd] = '\0'; // the FEN ends where the opcodes begin
+        chrono::steady_clock::time_point parseStart = chrono::steady_clock::now();
+        bool parsed = board.fromFEN(line.c_str());
+        parseSeconds += chrono::duration<double>(chrono::steady_clock::now() - parseStart).count();
+        if (!parsed) {
+            cerr << "Line " << lineNumber << ": invalid FEN" << endl;
+            failures++;
+            continue;
+        }
+        positions++;
+
+        // Each ";D<depth> <count>" entry
+        for (size_t pos = opcodes; pos != string::npos && pos < line.size(); pos = line.find(';', pos + 1)) {
+            const char* entry = line.c_str() + pos + 1;
+            while (*entry == ' ') {
+                entry++;
+            }
+            if (*entry != 'D') {
+                continue;
+            }
+            char* end;
+            int depth = (int)strtol(entry + 1, &end, 10);
+            long long expected = strtoll(end, nullptr, 10);
+            if (depth < 1 || depth > maxDepth) {
+                continue;
+            }
+            long long count = perft.countNodes(depth);
+            nodes += count;
+            checks++;
+            if (count != expected) {
+                cout << "Line " << lineNumber << " depth " << depth << ": " << count << " expected " << expected
+                    << " (MISMATCH) " << board.toFEN() << endl;
+                failures++;
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Positions: " << positions << endl;
+    cout << "Positions/sec parsed: " << (long long)(positions / max(parseSeconds, 1e-9)) << endl;
+    cout << "Checks: " << checks << ", failed: " << failures << endl;
+    cout << "Nodes: " << nodes << endl;
+    cout << "Time: " << seconds << " s" << endl;
+    cout << "Nodes/sec: " << (long long)(nodes / max(seconds, 1e-9)) << endl;
+    return (failures) ? 2 : 0;
+}
+
+// Plays the setup moves, returns false on the first one that is not legal
+bool applyMoves(Perft& perft, const vector<string>& moveTexts) {
+    for (const string& text : moveTexts) {
+        Move move = Move::fromString(text);
+        MoveList legalMoves = perft.getLegalMoves();
+        bool promotes = any_of(legalMoves.begin(), legalMoves.end(), [&](const Move& m) { return m.from == move.from && m.to == move.to && m.promotion != PieceType::EMPTY; });
+        if (promotes && move.promotion == PieceType::EMPTY) {
+            move.promotion = PieceType::QUEEN;
+        }
+        if (!legalMoves.contains(move)) {
+            cerr << "Illegal move: " << text << endl;
+            return false;
+        }
+        perft.getExecutor().makeMove(move);
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    int depth = atoi(argv[1]);
+    if (depth < 1) {
+        printUsage();
+        return 1;
+    }
+    int threads = 0;
+    int splitDepth = 2;
+    size_t hashMegabytes = 0;
+    const char* fen = nullptr;
+    const char* suitePath = nullptr;
+    int arg = 2;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (strcmp(argv[arg], "-t") == 0) {
+            threads = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "--split") == 0) {
+            splitDepth = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "--hash") == 0) {
+            hashMegabytes = atoi(argv[arg + 1]);
+        }
+        else if (strcmp(argv[arg], "--sliders") == 0) {
+            string mode = argv[arg + 1];
+            if (mode != "rays" && mode != "magic" && mode != "pext") {
+                printUsage();
+                return 1;
+            }
+            if (!AttackTables::setSliderMode((mode == "rays") ? SliderMode::RAYS : (mode == "pext") ? SliderMode::PEXT : SliderMode::MAGIC)) {
+                cerr << "PEXT sliders need a build with CHESS_BMI2" << endl;
+                return 1;
+            }
+        }
+        else if (strcmp(argv[arg], "--fen") == 0) {
+            fen = argv[arg + 1];
+        }
+        else if (strcmp(argv[arg], "--epd") == 0) {
+            suitePath = argv[arg + 1];
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    vector<string> moveTexts(argv + arg, argv + argc);
+
+    unique_ptr<PerftCache> cache((hashMegabytes) ? new PerftCache(hashMegabytes) : nullptr);
+    if (suitePath) {
+        return checkSuite(suitePath, depth, cache.get());
+    }
+    Board board(BOARD_HEIGHT, BOARD_WIDTH);
+    if (fen && !board.fromFEN(fen)) {
+        cerr << "Invalid FEN: " << fen << endl;
+        return 1;
+    }
+    Perft perft(&board, cache.get());
+    if (!applyMoves(perft, moveTexts)) {
+        return 1;
+    }
+
+    vector<pair<Move, long long>> counts;
+    counts.reserve(MAX_MOVES);
+    vector<PerftThreadReport> reports;
+    unique_ptr<WorkStealingPool> pool((threads > 0) ? new WorkStealingPool(threads) : nullptr);
+    long long allocationsBefore = allocationCount;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (pool) {
+        ParallelPerft(*pool, cache.get()).divide(board, depth, splitDepth, counts, reports);
+    }
+    else {
+        perft.divide(depth, counts);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long long allocations = allocationCount - allocationsBefore;
+
+    long long nodes = 0;
+    for (const pair<Move, long long>& count : counts) {
+        cout << count.first.toString() << ": " << count.second << endl;
+        nodes += count.second;
+    }
+    cout << endl;
+    cout << "Moves: " << counts.size() << endl;
+    cout << "Nodes: " << nodes << endl;
+    cout << "Time: " << seconds << " s" << endl;
+    cout << "Nodes/sec: " << (long long)(nodes / max(seconds, 1e-9)) << endl;
+    // Only the pool allocates, for its tasks
+    bool allocated = !pool && allocations != 0;
+    cout << "Heap allocations: " << allocations << ((allocated) ? " (FAIL)" : "") << endl;
+    const char* sliderNames[] = { "rays", "magic", "pext" };
+    cout << "Sliders: " << sliderNames[(int)AttackTables::getSliderMode()] << endl;
+    for (int t = 0; t < (int)reports.size(); t++) {
+        const PerftThreadReport& report = reports.at(t);
+        cout << "Thread " << t << ": " << report.nodes << " nodes, " << report.tasks << " tasks ("
+            << report.stolen << " stolen), " << (long long)(report.nodes / max(report.busySeconds, 1e-9)) << " nodes/sec, "
+            << (int)(100 * report.busySeconds / max(seconds, 1e-9)) << "% busy" << endl;
+    }
+
+    // Only the untouched start position has published counts to check against
+    long long expected = (moveTexts.empty() && !fen) ? Perft::getStartPositionCount(depth) : -1;
+    if (expected < 0) {
+        cout << "Expected: no reference count" << endl;
+        return (allocated) ? 3 : 0;
+    }
+    cout << "Expected: " << expected << ((nodes == expected) ? " (ok)" : " (MISMATCH)") << endl;
+    return (nodes != expected) ? 2 : (allocated) ? 3 : 0;
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include "moves/MoveValidator.h"
+#include "moves/MoveExecutor.h"
+#include "moves/SanParser.h"
+#include "util/PgnReader.h"
+#include "constants/Constants.h"
+using namespace std;
+
+void printUsage() {
+    cout << "Usage: pgn <file> [--quiet]" << endl;
+    cout << "Replays every game of a PGN file through the move rules and reports" << endl;
+    cout << "games/sec and moves/sec. Each illegal, ambiguous or unreadable move is" << endl;
+    cout << "reported with its game, line and column, and the rest of that game is" << endl;
+    cout << "skipped. --quiet only prints the totals." << endl;
+}
+
+// Counts for the whole file
+struct ReplayTotals {
+    long long games = 0, moves = 0, badGames = 0;
+};
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    bool quiet = argc > 2 && strcmp(argv[2], "--quiet") == 0;
+    PgnReader reader(argv[1]);
+    if (!reader.isOpen()) {
+        cerr << "Cannot open " << argv[1] << endl;
+        return 1;
+    }
+
+    Board board(BOARD_HEIGHT, BOARD_WIDTH);
+    MoveValidator validator(&board);
+    MoveExecutor executor(&board, &validator);
+    MoveList legalMoves;
+    PgnToken token;
+    char setupFen[PgnToken::MAX_TEXT] = "";
+    bool inMovetext = false, failed = false;
+    ReplayTotals totals;
+
+    // A game is set up at its first move, so the tags before it can supply a FEN
+    auto startGame = [&]() {
+        inMovetext = true;
+        failed = false;
+        executor.clearHistory();
+        if (!board.fromFEN((setupFen[0]) ? setupFen : START_FEN.c_str())) {
+            if (!quiet) {
+                cout << "Game " << totals.games + 1 << ", line " << token.line << ": invalid FEN tag" << endl;
+            }
+            failed = true;
+        }
+    };
+    auto endGame = [&]() {
+        totals.games++;
+        totals.badGames += failed;
+        inMovetext = false;
+        setupFen[0] = '\0';
+    };
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (reader.nextToken(token); token.type != PgnTokenType::END; reader.nextToken(token)) {
+        if (token.type == PgnTokenType::TAG) {
+            if (inMovetext) {
+                endGame(); // the previous game had no result
+            }
+            if (strcmp(token.name, "FEN") == 0) {
+                memcpy(setupFen, token.value, token.valueLength + 1);
+            }
+        }
+        else if (token.type == PgnTokenType::RESULT) {
+            if (!inMovetext) {
+                startGame();
+            }
+            endGame();
+        }
+        else {
+            if (!inMovetext) {
+                startGame();
+            }
+            if (failed) {
+                continue;
+            }
+            legalMoves.clear();
+            validator.getLegalMoves(legalMoves);
+            Move move;
+            int matches = SanParser::resolve(board, legalMoves, token.name, token.nameLength, move);
+            if (matches != 1) {
+                if (!quiet) {
+                    cout << "Game " << totals.games + 1 << ", line " << token.line << ", column " << token.column
+                        << ": " << ((matches) ? "ambiguous" : "illegal") << " move " << token.name
+                        << " in " << board.toFEN() << endl;
+                }
+                failed = true;
+                continue;
+            }
+            executor.makeMove(move);
+            totals.moves++;
+        }
+    }
+    if (inMovetext) {
+        endGame();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Games: " << totals.games << " (" << totals.badGames << " with errors)" << endl;
+    cout << "Moves: " << totals.moves << endl;
+    cout << "Bytes: " << reader.getBytesRead() << endl;
+    cout << "Time: " << seconds << " s" << endl;
+    cout << "Games/sec: " << (long long)(totals.games / max(seconds, 1e-9)) << endl;
+    cout << "Moves/sec: " << (long long)(totals.moves / max(seconds, 1e-9)) << endl;
+    cout << "MB/sec: " << reader.getBytesRead() / 1e6 / max(seconds, 1e-9) << endl;
+    return (totals.badGames) ? 2 : 0;
+}
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include "search/ParallelSearch.h"
+#include "constants/Constants.h"
+using namespace std;
+
+const int SCALING_THREAD_COUNTS[] = { 1, 2, 4, 8, 16 };
+
+void printUsage() {
+    cout << "Usage: search <seconds> [-t threads] [move ...]" << endl;
+    cout << "       search --scaling <depth> [move ...]" << endl;
+    cout << "Searches the start position, after playing the optional moves in" << endl;
+    cout << "coordinate notation, and prints each completed depth. With --scaling" << endl;
+    cout << "the time to reach the depth is compared for 1 to 16 threads." << endl;
+}
+
+string pvToString(const vector<Move>& pv) {
+    string text;
+    for (const Move& move : pv) {
+        text += (text.empty() ? "" : " ") + move.toString();
+    }
+    return text;
+}
+
+// Plays the setup moves, promotions default to a queen
+bool applyMoves(Board& board, char* moveTexts[], int count) {
+    MoveValidator validator(&board);
+    MoveExecutor executor(&board, &validator);
+    for (int i = 0; i < count; i++) {
+        Move move = Move::fromString(moveTexts[i]);
+        MoveList legalMoves;
+        validator.getLegalMoves(legalMoves);
+        if (!legalMoves.contains(move)) {
+            move.promotion = PieceType::QUEEN;
+        }
+        if (!legalMoves.contains(move)) {
+            cerr << "Illegal move: " << moveTexts[i] << endl;
+            return false;
+        }
+        executor.makeMove(move);
+    }
+    return true;
+}
+
+// Time to reach a fixed depth with each thread count, the table is cleared between runs
+void reportScaling(const Board& board, int depth) {
+    TranspositionTable table(DEFAULT_HASH_MEGABYTES);
+    SearchLimits limits;
+    limits.maxDepth = depth;
+    double baseSeconds = 0;
+    cout << "Hardware threads: " << thread::hardware_concurrency() << endl;
+    for (int threads : SCALING_THREAD_COUNTS) {
+        table.clear();
+        SearchResult result = ParallelSearch(table, threads).run(board, limits);
+        if (threads == 1) {
+            baseSeconds = result.seconds;
+        }
+        cout << "threads " << threads << " time " << result.seconds << " s nodes " << result.nodes
+            << " nodes/sec " << (long long)(result.nodes / max(result.seconds, 1e-9))
+            << " speedup " << baseSeconds / max(result.seconds, 1e-9)
+            << " best " << result.bestMove.toString() << " score " << result.score << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    bool scaling = strcmp(argv[1], "--scaling") == 0;
+    int arg = (scaling) ? 2 : 1;
+    if (arg >= argc) {
+        printUsage();
+        return 1;
+    }
+    double limit = atof(argv[arg++]);
+    if (limit <= 0) {
+        printUsage();
+        return 1;
+    }
+    int threads = 1;
+    if (!scaling && arg + 1 < argc && strcmp(argv[arg], "-t") == 0) {
+        threads = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+
+    Board board(BOARD_HEIGHT, BOARD_WIDTH);
+    if (!applyMoves(board, argv + arg, argc - arg)) {
+        return 1;
+    }
+    if (scaling) {
+        reportScaling(board, (int)limit);
+        return 0;
+    }
+
+    TranspositionTable table(DEFAULT_HASH_MEGABYTES);
+    SearchLimits limits;
+    limits.maxSeconds = limit;
+    SearchResult result = ParallelSearch(table, threads).run(board, limits, [](const SearchResult& info) {
+        cout << "depth " << info.depth << " score " << info.score << " nodes " << info.nodes
+            << " time " << info.seconds << " pv " << pvToString(info.pv) << endl;
+    });
+
+    cout << endl;
+    cout << "Best move: " << result.bestMove.toString() << endl;
+    cout << "Depth: " << result.depth << endl;
+    cout << "Threads: " << threads << endl;
+    cout << "Nodes: " << result.nodes << endl;
+    cout << "Nodes/sec: " << (long long)(result.nodes / max(result.seconds, 1e-9)) << endl;
+    cout << "Hash probes: " << result.tableStats.probes << ", hits: " << result.tableStats.hits
+        << ", collisions: " << result.tableStats.collisions << ", full: " << table.getFullness() / 10.0 << "%" << endl;
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include "search/ParallelSearch.h"
+#include "constants/Constants.h"
+using namespace std;
+
+const int MAX_HASH_MEGABYTES = 4096;
+const int MAX_THREADS = 256;
+
+// Speaks the UCI protocol on stdin and stdout. Commands are read on the main
+// thread while a search runs on its own thread, so "stop" and "isready"
+// are answered during a search.
+class UciEngine {
+private:
+    Board board;
+    MoveValidator validator;
+    MoveExecutor executor;
+    TranspositionTable table;
+    vector<uint64_t> gameHistory; // hashes of the positions before board since the last capture or pawn move
+    int threads;
+
+    thread searchThread;
+    atomic<bool> stopRequest;
+    atomic<bool> infinite; // bestmove waits for "stop" even if the depth limit is reached
+    mutex outputLock;
+
+    void send(const string& line) {
+        lock_guard<mutex> guard(outputLock);
+        cout << line << endl;
+    }
+
+    // "cp <n>", or "mate <n>" in moves with a negative n when being mated
+    static string scoreToString(int score) {
+        if (score > MATE_SCORE - MAX_SEARCH_PLY) {
+            return "mate " + to_string((MATE_SCORE - score + 1) / 2);
+        }
+        if (score < -MATE_SCORE + MAX_SEARCH_PLY) {
+            return "mate " + to_string(-(MATE_SCORE + score) / 2);
+        }
+        return "cp " + to_string(score);
+    }
+
+    void sendInfo(const SearchResult& result) {
+        ostringstream info;
+        info << "info depth " << result.depth << " score " << scoreToString(result.score) << " nodes " << result.nodes
+            << " nps " << (long long)(result.nodes / max(result.seconds, 1e-9)) << " time " << (long long)(result.seconds * 1000) << " pv";
+        for (const Move& move : result.pv) {
+            info << ' ' << move.toString();
+        }
+        send(info.str());
+    }
+
+    void waitForSearch() {
+        if (searchThread.joinable()) {
+            searchThread.join();
+        }
+    }
+
+    void stopSearch() {
+        stopRequest = true;
+        infinite = false;
+        waitForSearch();
+    }
+
+    // position [startpos | fen <fen>] [moves <move> ...]
+    // The moves are played on a copy, the position only changes if all of them are legal
+    void setPosition(istringstream& input) {
+        string word, fen;
+        input >> word;
+        if (word == "startpos") {
+            fen = START_FEN;
+            input >> word;
+        }
+        else if (word == "fen") {
+            while (input >> word && word != "moves") {
+                fen += (fen.empty() ? "" : " ") + word;
+            }
+        }
+        else {
+            return;
+        }
+        Board position(BOARD_HEIGHT, BOARD_WIDTH);
+        if (!position.fromFEN(fen)) {
+            send("info string invalid fen " + fen);
+            return;
+        }
+        MoveValidator positionValidator(&position);
+        MoveExecutor positionExecutor(&position, &positionValidator);
+        vector<uint64_t> history;
+        MoveList legalMoves;
+        for (bool moves = word == "moves"; moves && input >> word;) {
+            Move move = Move::fromString(word);
+            legalMoves.clear();
+            positionValidator.getLegalMoves(legalMoves);
+            if (!legalMoves.contains(move)) {
+                send("info string illegal move " + word + ", position not changed");
+                return;
+            }
+            uint64_t before = position.getHash();
+            positionExecutor.makeMove(move);
+            // Nothing before a capture or pawn move can come back
+            if (position.getHalfmoveClock() == 0) {
+                history.clear();
+            }
+            else {
+                history.push_back(before);
+            }
+        }
+        board = position;
+        executor.clearHistory();
+        gameHistory = move(history);
+    }
+
+    // setoption name <id> value <x>
+    void setOption(istringstream& input) {
+        string word, name, value;
+        input >> word;
+        while (input >> word && word != "value") {
+            name += (name.empty() ? "" : " ") + word;
+        }
+        input >> value;
+        if (name == "Hash") {
+            table.resize(min(max(atoi(value.c_str()), 1), MAX_HASH_MEGABYTES));
+        }
+        else if (name == "Threads") {
+            threads = min(max(atoi(value.c_str()), 1), MAX_THREADS);
+        }
+        else if (name == "SyzygyPath") {
+            Tablebase::setPaths((value == "<empty>") ? "" : value);
+        }
+        else if (name == "EvalFile") {
+            // Without a network the piece-square evaluation is used
+            if (value.empty() || value == "<empty>") {
+                Nnue::unload();
+            }
+            else if (!Nnue::load(value)) {
+                Nnue::unload();
+                send("info string cannot load network " + value);
+            }
+        }
+        else {
+            send("info string unknown option " + name);
+        }
+    }
+
+    // Spends a share of the remaining clock plus most of the increment
+    static double allocateTime(long long remainingMs, long long incrementMs, int movesToGo) {
+        double budget = remainingMs / (double)((movesToGo > 0) ? movesToGo : 30) + incrementMs * 0.8;
+        return max(min(budget, remainingMs - 50.0), 1.0) / 1000.0;
+    }
+
+    // go [depth n] [nodes n] [movetime ms] [wtime ms btime ms winc ms binc ms movestogo n] [infinite]
+    void go(istringstream& input) {
+        SearchLimits limits;
+        long long times[2] = { 0, 0 }, increments[2] = { 0, 0 };
+        int movesToGo = 0;
+        bool clock = false;
+        infinite = false;
+        string word;
+        while (input >> word) {
+            if (word == "depth") {
+                input >> limits.maxDepth;
+            }
+            else if (word == "nodes") {
+                input >> limits.maxNodes;
+            }
+            else if (word == "movetime") {
+                long long ms;
+                input >> ms;
+                limits.maxSeconds = ms / 1000.0;
+            }
+            else if (word == "wtime" || word == "btime") {
+                input >> times[word[0] == 'b'];
+                clock = true;
+            }
+            else if (word == "winc" || word == "binc") {
+                input >> increments[word[0] == 'b'];
+            }
+            else if (word == "movestogo") {
+                input >> movesToGo;
+            }
+            else if (word == "infinite") {
+                infinite = true;
+            }
+        }
+        limits.maxDepth = min(max(limits.maxDepth, 1), MAX_SEARCH_PLY - 1);
+        if (clock && limits.maxSeconds == 0 && !infinite) {
+            int side = (board.getSideToMove() == PieceSide::BLACK);
+            limits.maxSeconds = allocateTime(times[side], increments[side], movesToGo);
+        }
+
+        stopRequest = false;
+        searchThread = thread([this, limits]() {
+            SearchResult result = ParallelSearch(table, threads).run(board, limits,
+                [this](const SearchResult& info) { sendInfo(info); }, &stopRequest, gameHistory);
+            while (infinite && !stopRequest) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+            send("bestmove " + result.bestMove.toString());
+        });
+    }
+
+public:
+    UciEngine() : board(BOARD_HEIGHT, BOARD_WIDTH), validator(&board), executor(&board, &validator),
+        table(DEFAULT_HASH_MEGABYTES), threads(1), stopRequest(false), infinite(false) {}
+
+    ~UciEngine() {
+        stopSearch();
+    }
+
+    // Reads commands until "quit" or the end of input
+    void loop() {
+        string line;
+        while (getline(cin, line)) {
+            istringstream input(line);
+            string command;
+            input >> command;
+            if (command == "uci") {
+                send("id name Chess");
+                send("id author Chess contributors");
+                send("option name Hash type spin default " + to_string(DEFAULT_HASH_MEGABYTES) + " min 1 max " + to_string(MAX_HASH_MEGABYTES));
+                send("option name Threads type spin default 1 min 1 max " + to_string(MAX_THREADS));
+                send("option name SyzygyPath type string default <empty>");
+                send("option name EvalFile type string default <empty>");
+                send("uciok");
+            }
+            else if (command == "isready") {
+                send("readyok");
+            }
+            else if (command == "ucinewgame") {
+                stopSearch();
+                table.clear();
+            }
+            else if (command == "setoption") {
+                stopSearch();
+                setOption(input);
+            }
+            else if (command == "position") {
+                stopSearch();
+                setPosition(input);
+            }
+            else if (command == "go") {
+                stopSearch();
+                go(input);
+            }
+            else if (command == "stop") {
+                stopSearch();
+            }
+            else if (command == "d") {
+                send(board.toFEN());
+            }
+            else if (command == "quit") {
+                break;
+            }
+            else if (!command.empty()) {
+                send("info string unknown command " + command);
+            }
+        }
+    }
+};
+
+int main() {
+    ios::sync_with_stdio(false);
+    UciEngine engine;
+    engine.loop();
+    return 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "BitboardPosition.h"
+#include "../moves/AttackTables.h"
+
+// Squares attacked by each side, kept per piece so a move only recomputes the
+// pieces it touched and the sliders whose rays crossed a changed square.
+class AttackMap {
+private:
+    Bitboard pieceAttacks[64]; // attacks of the piece standing on each square
+    Bitboard sideAttacks[2];
+
+    void computePiece(const BitboardPosition& bb, int pos) {
+        PieceType type = bb.getTypeAt(pos);
+        pieceAttacks[pos] = (type == PieceType::EMPTY) ? EMPTY_BITBOARD
+            : AttackTables::getAttacks(type, bb.getSideAt(pos), pos, bb.getOccupied());
+    }
+
+    void combineSides(const BitboardPosition& bb) {
+        for (int i = 0; i < 2; i++) {
+            Bitboard pieces = bb.getOccupied((i) ? PieceSide::BLACK : PieceSide::WHITE);
+            sideAttacks[i] = EMPTY_BITBOARD;
+            while (pieces) {
+                sideAttacks[i] |= pieceAttacks[popLsb(pieces)];
+            }
+        }
+    }
+
+public:
+    AttackMap() {
+        for (Bitboard& b : pieceAttacks) {
+            b = EMPTY_BITBOARD;
+        }
+        sideAttacks[0] = sideAttacks[1] = EMPTY_BITBOARD;
+    }
+
+    void rebuild(const BitboardPosition& bb) {
+        AttackTables::initialize();
+        for (int pos = 0; pos < 64; pos++) {
+            computePiece(bb, pos);
+        }
+        combineSides(bb);
+    }
+
+    // Bring the map up to date after the pieces on the changed squares were placed or removed
+    void update(const BitboardPosition& bb, Bitboard changed) {
+        if (!changed) {
+            return;
+        }
+        Bitboard affected = changed;
+        Bitboard sliders = (bb.getPieces(PieceType::BISHOP) | bb.getPieces(PieceType::ROOK) | bb.getPieces(PieceType::QUEEN)) & ~changed;
+        while (sliders) {
+            int pos = popLsb(sliders);
+            if (pieceAttacks[pos] & changed) {
+                affected |= squareBit(pos);
+            }
+        }
+        while (affected) {
+            computePiece(bb, popLsb(affected));
+        }
+        combineSides(bb);
+    }
+
+    bool isSquareAttacked(int pos, PieceSide bySide) const {
+        return testBit(sideAttacks[sideIndex(bySide)], pos);
+    }
+
+    Bitboard getAttacks(PieceSide bySide) const { return sideAttacks[sideIndex(bySide)]; }
+    Bitboard getPieceAttacks(int pos) const { return pieceAttacks[pos]; }
+};
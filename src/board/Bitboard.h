@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../constants/Constants.h"
+#include "../constants/Enums.h"
+
+// One bit per square, bit index == board position (0 = a1, 63 = h8)
+typedef uint64_t Bitboard;
+
+static_assert(BOARD_WIDTH * BOARD_HEIGHT == 64, "Bitboards require a 64 square board");
+
+const Bitboard EMPTY_BITBOARD = 0ULL;
+const Bitboard FILE_A = 0x0101010101010101ULL;
+const Bitboard FILE_H = FILE_A << (BOARD_WIDTH - 1);
+const Bitboard RANK_1 = 0xFFULL;
+const Bitboard RANK_8 = RANK_1 << (BOARD_WIDTH * (BOARD_HEIGHT - 1));
+
+constexpr Bitboard squareBit(int pos) {
+    return 1ULL << pos;
+}
+
+inline bool testBit(Bitboard b, int pos) {
+    return (b >> pos) & 1ULL;
+}
+
+inline int popCount(Bitboard b) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(b);
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit, b must be non-empty
+inline int lsb(Bitboard b) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanForward64(&idx, b);
+    return (int)idx;
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+// Index of the most significant set bit, b must be non-empty
+inline int msb(Bitboard b) {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, b);
+    return (int)idx;
+#else
+    return 63 ^ __builtin_clzll(b);
+#endif
+}
+
+inline int popLsb(Bitboard& b) {
+    int pos = lsb(b);
+    b &= b - 1;
+    return pos;
+}
+
+inline int sideIndex(PieceSide side) {
+    return side == PieceSide::BLACK;
+}
+
+inline PieceSide oppositeSide(PieceSide side) {
+    return (side == PieceSide::WHITE) ? PieceSide::BLACK : PieceSide::WHITE;
+}
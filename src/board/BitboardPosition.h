@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Bitboard.h"
+
+// Piece placement as bitboards, one mask per piece type and one per side.
+// Kept in sync with the cells of Board by Board itself.
+class BitboardPosition {
+private:
+    Bitboard byType[7]; // indexed by PieceType, EMPTY holds every occupied square
+    Bitboard bySide[2];
+
+public:
+    BitboardPosition() {
+        clear();
+    }
+
+    void clear() {
+        for (Bitboard& b : byType) {
+            b = EMPTY_BITBOARD;
+        }
+        bySide[0] = bySide[1] = EMPTY_BITBOARD;
+    }
+
+    void addPiece(int pos, PieceType type, PieceSide side) {
+        Bitboard bit = squareBit(pos);
+        byType[(int)PieceType::EMPTY] |= bit;
+        byType[(int)type] |= bit;
+        bySide[sideIndex(side)] |= bit;
+    }
+
+    void removePiece(int pos, PieceType type, PieceSide side) {
+        Bitboard bit = squareBit(pos);
+        byType[(int)PieceType::EMPTY] &= ~bit;
+        byType[(int)type] &= ~bit;
+        bySide[sideIndex(side)] &= ~bit;
+    }
+
+    void movePiece(int from, int to, PieceType type, PieceSide side) {
+        Bitboard fromTo = squareBit(from) | squareBit(to);
+        byType[(int)PieceType::EMPTY] ^= fromTo;
+        byType[(int)type] ^= fromTo;
+        bySide[sideIndex(side)] ^= fromTo;
+    }
+
+    Bitboard getPieces(PieceType type) const { return byType[(int)type]; }
+    Bitboard getPieces(PieceType type, PieceSide side) const { return byType[(int)type] & bySide[sideIndex(side)]; }
+    Bitboard getOccupied() const { return byType[(int)PieceType::EMPTY]; }
+    Bitboard getOccupied(PieceSide side) const { return bySide[sideIndex(side)]; }
+
+    PieceType getTypeAt(int pos) const {
+        for (int type = (int)PieceType::PAWN; type <= (int)PieceType::KING; type++) {
+            if (testBit(byType[type], pos)) {
+                return (PieceType)type;
+            }
+        }
+        return PieceType::EMPTY;
+    }
+
+    PieceSide getSideAt(int pos) const {
+        return testBit(bySide[sideIndex(PieceSide::BLACK)], pos) ? PieceSide::BLACK
+            : testBit(bySide[sideIndex(PieceSide::WHITE)], pos) ? PieceSide::WHITE : PieceSide::NONE;
+    }
+
+    int getKingPos(PieceSide side) const {
+        Bitboard king = getPieces(PieceType::KING, side);
+        return (king) ? lsb(king) : NONE_SELECTED;
+    }
+};
@@ -1,76 +1,416 @@
 #pragma once
 
-#include "Cell.h"
+#include "BitboardPosition.h"
+#include "AttackMap.h"
+#include "Zobrist.h"
+#include "PieceSquare.h"
+#include "../pieces/ChessPiece.h"
+#include "../pieces/ChessPieceBuilder.h"
 #include "../constants/Constants.h"
 #include "../constants/Enums.h"
 #include <vector>
+#include <string>
 
 using namespace std;
 
 class Board {
 private:
     int height, width;
-    vector<Cell> cells;
+    ChessPiece squares[BOARD_HEIGHT * BOARD_WIDTH]; // one byte per square
+    BitboardPosition bitboards;
+    AttackMap attackMap;
+    Bitboard changedSquares; // placed or cleared since the attack map was last updated
+    PieceSide sideToMove;
+    int castlingRights;
     int enPassantMove;
-    vector<int> scores;
+    uint64_t hashKey; // Zobrist key, kept up to date by every change below
+    int halfmoveClock; // plies since the last capture or pawn move
+    int fullmoveNumber;
+    int middlegameScore, endgameScore; // PieceSquare sums for white minus black
+    int phase; // PieceSquare phase weights of the pieces on the board
     vector<vector<ChessPiece>> captures;
 
+    // Adds (sign 1) or takes away (sign -1) the PieceSquare terms of a piece on pos
+    void scorePiece(const ChessPiece& piece, int pos, int sign) {
+        middlegameScore += sign * PieceSquare::getMiddlegame(piece.getType(), piece.getSide(), pos);
+        endgameScore += sign * PieceSquare::getEndgame(piece.getType(), piece.getSide(), pos);
+        phase += sign * PieceSquare::getPhase(piece.getType());
+    }
+
 public:
-    Board(int h, int w, sf::Sound& sound) {
+    Board(int h, int w) {
         height = h;
         width = w;
+        Zobrist::initialize();
+        PieceSquare::initialize();
+        hashKey = 0;
+        middlegameScore = endgameScore = phase = 0;
+        sideToMove = PieceSide::WHITE;
+        castlingRights = CASTLE_ALL;
         enPassantMove = NONE_SELECTED;
-        scores = vector<int>(2);
+        halfmoveClock = 0;
+        fullmoveNumber = 1;
         captures = vector<vector<ChessPiece>>(2);
-        cells = vector<Cell>(h * w);
-        
-        initializePieces(sound);
+
+        initializePieces();
+        hashKey = computeHash();
+        attackMap.rebuild(bitboards);
+        changedSquares = EMPTY_BITBOARD;
     }
 
-    void initializePieces(sf::Sound& sound) {
+    void initializePieces() {
         vector<ChessPiece> standardBackRow = ChessPieceFactory::createStandardBackRow();
-        
+
         for (int j = 0; j < 2; j++) {
             vector<ChessPiece> backRow = standardBackRow;
             for (int i = 0; i < width; i++) {
                 ChessPiece& backPiece = backRow.at(i);
-                ChessPiece pawn = ChessPieceFactory::createPiece(PieceType::PAWN);
-                backPiece.setSound(&sound);  
-                pawn.setSound(&sound);
+                ChessPiece pawn(PieceType::PAWN);
                 if (j) {
                     backPiece.switchSide();
                     pawn.switchSide();
                 }
-                cells.at(i + j * (height * width - width)).setChessPiece(backPiece);
-                cells.at(width + i + (height * (width - 3)) * j).setChessPiece(pawn);
+                setPiece(i + j * (height * width - width), backPiece);
+                setPiece(width + i + (height * (width - 3)) * j, pawn);
             }
         }
-        
-        // Setup cells
-        for (int i = 0; i < height * width; i++) {
-            Cell& c = cells.at(i);
-            bool whiteSquare = (i % 2 == i / height % 2);
-            c.setDefaultColor((whiteSquare) ? sf::Color::White : sf::Color::Black);
-            c.setSize(sf::Vector2f(CELL_WIDTH, CELL_WIDTH));
-            c.setPos(sf::Vector2f(CELL_WIDTH * (i % width), CELL_WIDTH * (i / height) + Y_OFFSET));
-        }
     }
 
-    Cell& getCell(int pos) { return cells.at(pos); }
-    const vector<Cell>& getCells() const { return cells; }
+    ChessPiece& getPiece(int pos) { return squares[pos]; }
+    const ChessPiece& getPiece(int pos) const { return squares[pos]; }
+    const BitboardPosition& getBitboards() const { return bitboards; }
+    const AttackMap& getAttackMap() const { return attackMap; }
     int getHeight() const { return height; }
     int getWidth() const { return width; }
+    PieceSide getSideToMove() const { return sideToMove; }
+    int getCastlingRights() const { return castlingRights; }
     int getEnPassantMove() const { return enPassantMove; }
-    const vector<int>& getScores() const { return scores; }
+    uint64_t getHash() const { return hashKey; }
+    int getHalfmoveClock() const { return halfmoveClock; }
+    int getFullmoveNumber() const { return fullmoveNumber; }
+    int getMiddlegameScore() const { return middlegameScore; }
+    int getEndgameScore() const { return endgameScore; }
+    int getPhase() const { return phase; }
     const vector<vector<ChessPiece>>& getCaptures() const { return captures; }
-    
-    void setEnPassantMove(int move) { enPassantMove = move; }
-    void addScore(int side, int value) { scores.at(side) += value; }
+
+    void setSideToMove(PieceSide side) {
+        if (side != sideToMove) {
+            hashKey ^= Zobrist::getSideKey();
+        }
+        sideToMove = side;
+    }
+
+    void setCastlingRights(int rights) {
+        hashKey ^= Zobrist::getCastlingKey(castlingRights) ^ Zobrist::getCastlingKey(rights);
+        castlingRights = rights;
+    }
+
+    void setEnPassantMove(int move) {
+        hashKey ^= Zobrist::getEnPassantKey(enPassantMove) ^ Zobrist::getEnPassantKey(move);
+        enPassantMove = move;
+    }
+    void setHalfmoveClock(int clock) { halfmoveClock = clock; }
+    void setFullmoveNumber(int number) { fullmoveNumber = number; }
     void addCapture(int side, const ChessPiece& piece) { captures.at(side).push_back(piece); }
-    
-    int size() const { return cells.size(); }
-    
+
+    int size() const { return height * width; }
+
+    // Rights lost when a piece leaves or lands on pos (king and rook home squares)
+    int castlingRightsAt(int pos) const {
+        int file = pos % width;
+        int rights = 0;
+        if (pos / width == 0) {
+            rights = (file == 4) ? CASTLE_WHITE_KINGSIDE | CASTLE_WHITE_QUEENSIDE
+                : (file == width - 1) ? CASTLE_WHITE_KINGSIDE : (file == 0) ? CASTLE_WHITE_QUEENSIDE : 0;
+        }
+        else if (pos / width == height - 1) {
+            rights = (file == 4) ? CASTLE_BLACK_KINGSIDE | CASTLE_BLACK_QUEENSIDE
+                : (file == width - 1) ? CASTLE_BLACK_KINGSIDE : (file == 0) ? CASTLE_BLACK_QUEENSIDE : 0;
+        }
+        return rights;
+    }
+
+    // PieceSquare sums built from scratch, checks the incremental ones in debug builds
+    void computePieceSquare(int& middlegame, int& endgame, int& piecePhase) const {
+        middlegame = endgame = piecePhase = 0;
+        Bitboard occupied = bitboards.getOccupied();
+        while (occupied) {
+            int pos = popLsb(occupied);
+            middlegame += PieceSquare::getMiddlegame(squares[pos].getType(), squares[pos].getSide(), pos);
+            endgame += PieceSquare::getEndgame(squares[pos].getType(), squares[pos].getSide(), pos);
+            piecePhase += PieceSquare::getPhase(squares[pos].getType());
+        }
+    }
+
+    bool pieceSquareMatches() const {
+        int middlegame, endgame, piecePhase;
+        computePieceSquare(middlegame, endgame, piecePhase);
+        return middlegame == middlegameScore && endgame == endgameScore && piecePhase == phase;
+    }
+
+    // Zobrist key built from scratch, checks the incremental hashKey in debug builds
+    uint64_t computeHash() const {
+        uint64_t key = Zobrist::getCastlingKey(castlingRights) ^ Zobrist::getEnPassantKey(enPassantMove);
+        if (sideToMove == PieceSide::BLACK) {
+            key ^= Zobrist::getSideKey();
+        }
+        Bitboard occupied = bitboards.getOccupied();
+        while (occupied) {
+            int pos = popLsb(occupied);
+            key ^= Zobrist::getPieceKey(squares[pos].getType(), squares[pos].getSide(), pos);
+        }
+        return key;
+    }
+
+    // Replaces the position with the one in a FEN record. The move counters may
+    // be left out. Returns false and leaves the board untouched if malformed or
+    // impossible: the side not to move in check, a pawn on rank 1 or 8, or an
+    // en passant square behind the wrong side's pawn.
+    bool fromFEN(const string& fen) {
+        return fromFEN(fen.c_str());
+    }
+
+    bool fromFEN(const char* c) {
+        ChessPiece placement[BOARD_HEIGHT * BOARD_WIDTH];
+        BitboardPosition placed;
+        int kings[2] = { 0, 0 };
+
+        // Ranks from 8 down to 1, files a to h
+        for (int rank = height - 1; rank >= 0; rank--) {
+            int file = 0;
+            while (file < width) {
+                if (*c >= '1' && *c <= '8') {
+                    file += *c - '0';
+                }
+                else {
+                    PieceType type = pieceTypeFromChar(*c);
+                    if (type == PieceType::EMPTY) {
+                        return false;
+                    }
+                    PieceSide side = (*c >= 'a') ? PieceSide::BLACK : PieceSide::WHITE;
+                    if (type == PieceType::PAWN && (rank == 0 || rank == height - 1)) {
+                        return false;
+                    }
+                    placed.addPiece(rank * width + file, type, side);
+                    placement[rank * width + file++] = ChessPiece(type, side);
+                    kings[sideIndex(side)] += (type == PieceType::KING);
+                }
+                c++;
+            }
+            if (file != width || *c != ((rank) ? '/' : ' ')) {
+                return false;
+            }
+            c++;
+        }
+        if (kings[0] != 1 || kings[1] != 1) {
+            return false;
+        }
+
+        if ((*c != 'w' && *c != 'b') || c[1] != ' ') {
+            return false;
+        }
+        PieceSide side = (*c == 'w') ? PieceSide::WHITE : PieceSide::BLACK;
+        c += 2;
+        AttackMap attacks;
+        attacks.rebuild(placed);
+        if (attacks.isSquareAttacked(placed.getKingPos(oppositeSide(side)), side)) {
+            return false;
+        }
+
+        int rights = 0;
+        if (*c == '-') {
+            c++;
+        }
+        while (*c != ' ') {
+            switch (*c++) {
+                case 'K': rights |= CASTLE_WHITE_KINGSIDE; break;
+                case 'Q': rights |= CASTLE_WHITE_QUEENSIDE; break;
+                case 'k': rights |= CASTLE_BLACK_KINGSIDE; break;
+                case 'q': rights |= CASTLE_BLACK_QUEENSIDE; break;
+                default: return false;
+            }
+        }
+        c++;
+
+        int enPassant = NONE_SELECTED;
+        if (*c == '-') {
+            c++;
+        }
+        else {
+            // The pawn that just moved belongs to the side not to move
+            if (*c < 'a' || *c >= 'a' + width || c[1] != ((side == PieceSide::WHITE) ? '6' : '3')) {
+                return false;
+            }
+            enPassant = (c[1] - '1') * width + (*c - 'a');
+            c += 2;
+        }
+
+        int counters[2] = { 0, 1 };
+        for (int i = 0; i < 2 && *c == ' '; i++) {
+            c++;
+            if (*c < '0' || *c > '9') {
+                return false;
+            }
+            counters[i] = 0;
+            while (*c >= '0' && *c <= '9') {
+                counters[i] = counters[i] * 10 + (*c++ - '0');
+            }
+        }
+
+        for (int pos = 0; pos < size(); pos++) {
+            removePiece(pos);
+            setPiece(pos, placement[pos]);
+        }
+        // Rights only stay where the king and rook are still on their home squares
+        castlingRights = CASTLE_ALL;
+        for (int pos = 0; pos < size(); pos++) {
+            int homeRights = castlingRightsAt(pos);
+            PieceType home = (pos % width == 4) ? PieceType::KING : PieceType::ROOK;
+            PieceSide homeSide = (pos < width) ? PieceSide::WHITE : PieceSide::BLACK;
+            if (homeRights && !(squares[pos].isOfType(home) && squares[pos].isOnSide(homeSide))) {
+                castlingRights &= ~homeRights;
+            }
+        }
+        castlingRights &= rights;
+        sideToMove = side;
+        enPassantMove = enPassant;
+        halfmoveClock = counters[0];
+        fullmoveNumber = max(counters[1], 1);
+        captures.assign(2, vector<ChessPiece>());
+
+        hashKey = computeHash();
+        attackMap = attacks;
+        changedSquares = EMPTY_BITBOARD;
+        return true;
+    }
+
+    string toFEN() const {
+        string fen;
+        fen.reserve(90);
+        for (int rank = height - 1; rank >= 0; rank--) {
+            int empty = 0;
+            for (int file = 0; file < width; file++) {
+                const ChessPiece& piece = squares[rank * width + file];
+                if (!piece.isActive()) {
+                    empty++;
+                    continue;
+                }
+                if (empty) {
+                    fen += (char)('0' + empty);
+                    empty = 0;
+                }
+                fen += pieceChar(piece);
+            }
+            if (empty) {
+                fen += (char)('0' + empty);
+            }
+            fen += (rank) ? '/' : ' ';
+        }
+        fen += (sideToMove == PieceSide::WHITE) ? "w " : "b ";
+        if (!castlingRights) {
+            fen += '-';
+        }
+        const char rightChars[] = "KQkq";
+        for (int i = 0; i < 4; i++) {
+            if (castlingRights & (1 << i)) {
+                fen += rightChars[i];
+            }
+        }
+        fen += ' ';
+        if (enPassantMove == NONE_SELECTED) {
+            fen += '-';
+        }
+        else {
+            fen += (char)('a' + enPassantMove % width);
+            fen += (char)('1' + enPassantMove / width);
+        }
+        fen += ' ' + to_string(halfmoveClock) + ' ' + to_string(fullmoveNumber);
+        return fen;
+    }
+
+    // FEN letter of a piece, upper case for white
+    static char pieceChar(const ChessPiece& piece) {
+        char letter = piece.getGlyph();
+        return (piece.getSide() == PieceSide::WHITE) ? letter - ('a' - 'A') : letter;
+    }
+
+    // Piece type of a FEN letter of either case, EMPTY if it is not one
+    static PieceType pieceTypeFromChar(char letter) {
+        switch (letter | ('a' - 'A')) {
+            case 'p': return PieceType::PAWN;
+            case 'n': return PieceType::KNIGHT;
+            case 'b': return PieceType::BISHOP;
+            case 'r': return PieceType::ROOK;
+            case 'q': return PieceType::QUEEN;
+            case 'k': return PieceType::KING;
+            default: return PieceType::EMPTY;
+        }
+    }
+
+    void updateAttacks() {
+        attackMap.update(bitboards, changedSquares);
+        changedSquares = EMPTY_BITBOARD;
+    }
+
+    // All piece placement changes go through these so the bitboards stay in sync
+    // and the squares are marked for the next updateAttacks
+    void setPiece(int pos, const ChessPiece& piece) {
+        removePiece(pos);
+        changedSquares |= squareBit(pos);
+        if (piece.isActive()) {
+            bitboards.addPiece(pos, piece.getType(), piece.getSide());
+            hashKey ^= Zobrist::getPieceKey(piece.getType(), piece.getSide(), pos);
+            scorePiece(piece, pos, 1);
+        }
+        squares[pos] = piece;
+    }
+
+    void removePiece(int pos) {
+        ChessPiece& old = squares[pos];
+        if (old.isActive()) {
+            bitboards.removePiece(pos, old.getType(), old.getSide());
+            hashKey ^= Zobrist::getPieceKey(old.getType(), old.getSide(), pos);
+            scorePiece(old, pos, -1);
+            changedSquares |= squareBit(pos);
+            old = ChessPiece();
+        }
+    }
+
+    // Moves the piece on pos into out, leaving the square empty
+    void takePiece(int pos, ChessPiece& out) {
+        ChessPiece& old = squares[pos];
+        if (old.isActive()) {
+            bitboards.removePiece(pos, old.getType(), old.getSide());
+            hashKey ^= Zobrist::getPieceKey(old.getType(), old.getSide(), pos);
+            scorePiece(old, pos, -1);
+            changedSquares |= squareBit(pos);
+        }
+        out = old;
+        old = ChessPiece();
+    }
+
+    // Moves a piece taken with takePiece back onto an empty square
+    void putPiece(int pos, ChessPiece& in) {
+        if (in.isActive()) {
+            bitboards.addPiece(pos, in.getType(), in.getSide());
+            hashKey ^= Zobrist::getPieceKey(in.getType(), in.getSide(), pos);
+            scorePiece(in, pos, 1);
+            changedSquares |= squareBit(pos);
+        }
+        squares[pos] = in;
+    }
+
     void movePiece(int from, int to) {
-        cells.at(from).movePiece(cells.at(to));
+        removePiece(to);
+        ChessPiece& moving = squares[from];
+        if (moving.isActive()) {
+            bitboards.movePiece(from, to, moving.getType(), moving.getSide());
+            hashKey ^= Zobrist::getPieceKey(moving.getType(), moving.getSide(), from) ^ Zobrist::getPieceKey(moving.getType(), moving.getSide(), to);
+            scorePiece(moving, from, -1);
+            scorePiece(moving, to, 1);
+            changedSquares |= squareBit(from) | squareBit(to);
+        }
+        squares[to] = moving;
+        moving = ChessPiece();
     }
 };
@@ -1,24 +1,51 @@
 #pragma once
 
 #include "Board.h"
+#include "Cell.h"
+#include "PieceAtlas.h"
+#include "../moves/MoveList.h"
+#include <sstream>
+#include <iomanip>
 #include <SFML/Graphics.hpp>
-#include <set>
 
 class BoardRenderer : public sf::Drawable {
 private:
     Board* state;
+    vector<Cell> cells;
     vector<sf::Text> scoreText;
+    // Rebuilt every frame, cleared rather than reallocated
+    mutable sf::VertexArray cellQuads;
+    mutable sf::VertexArray pieceQuads;
+
+    static void appendRect(sf::VertexArray& quads, sf::Vector2f topLeft, sf::Vector2f size, sf::Color color) {
+        quads.append(sf::Vertex(topLeft, color));
+        quads.append(sf::Vertex(sf::Vector2f(topLeft.x + size.x, topLeft.y), color));
+        quads.append(sf::Vertex(topLeft + size, color));
+        quads.append(sf::Vertex(sf::Vector2f(topLeft.x, topLeft.y + size.y), color));
+    }
     
 public:
-    BoardRenderer(Board* state, sf::Font& textFont) : state(state) {
+    BoardRenderer(Board* state, sf::Font& textFont) : state(state), cellQuads(sf::Quads), pieceQuads(sf::Quads) {
         scoreText = vector<sf::Text>(2);
+        cells = vector<Cell>(state->size());
+        
+        // Setup cells
+        int height = state->getHeight();
+        int width = state->getWidth();
+        for (int i = 0; i < cells.size(); i++) {
+            Cell& c = cells.at(i);
+            bool whiteSquare = (i % 2 == i / height % 2);
+            c.setDefaultColor((whiteSquare) ? sf::Color::White : sf::Color::Black);
+            c.setSize(sf::Vector2f(CELL_WIDTH, CELL_WIDTH));
+            c.setPos(sf::Vector2f(CELL_WIDTH * (i % width), CELL_WIDTH * (i / height) + Y_OFFSET));
+        }
         
         // Initialize score text
         for (int i = 0; i < scoreText.size(); i++) {
             sf::Text& t = scoreText.at(i);
             t.setCharacterSize(24);
             t.setFont(textFont);
-            t.setString("Score: 0");
+            t.setString("Eval: +0.00");
             sf::FloatRect textRect = t.getLocalBounds();
             t.setOrigin(textRect.left + textRect.width / 2.0f,
                 textRect.top + textRect.height / 2.0f);
@@ -26,23 +53,25 @@ public:
         }
     }
     
+    // Centipawn score shown in pawns
     void updateScoreText(int side, int score) {
         ostringstream text;
-        text << "Score: " << score;
+        text << "Eval: " << showpos << fixed << setprecision(2) << score / 100.0;
         scoreText.at(side).setString(text.str());
     }
     
-    void highlightValidMoves(const set<int>& moves, PieceSide side = PieceSide::NONE) {
-        for (int i : moves) {
-            sf::Color color = (!state->getCell(i).getChessPiece().isActive() || 
-                              state->getCell(i).getChessPiece().getSide() == side) ? 
+    void highlightValidMoves(const MoveList& moves, PieceSide side = PieceSide::NONE) {
+        for (const Move& move : moves) {
+            int i = move.to;
+            sf::Color color = (!state->getPiece(i).isActive() || 
+                              state->getPiece(i).getSide() == side) ? 
                               sf::Color::Green : sf::Color::Red;
-            state->getCell(i).toggleHighlight(color);
+            cells.at(i).toggleHighlight(color);
         }
     }
     
     void toggleCellSelected(int pos) {
-        state->getCell(pos).toggleSelected();
+        cells.at(pos).toggleSelected();
     }
     
     void draw(sf::RenderTarget& target, sf::RenderStates states) const override {
@@ -51,27 +80,32 @@ public:
         double capSize = DEFAULT_ITEM_SIZE * 0.7;
         int betweenCaptures = Y_OFFSET / 4;
         
-        // Draw the board cells and pieces
-        const vector<Cell>& cells = state->getCells();
+        // Cell outlines show through the gaps left between the cell quads
+        cellQuads.clear();
+        pieceQuads.clear();
+        appendRect(cellQuads, sf::Vector2f(-1, Y_OFFSET - 1), sf::Vector2f(BOARD_DIM_IN_WINDOW + 2, BOARD_DIM_IN_WINDOW + 2), sf::Color::Black);
         for (int i = 0; i < cells.size(); i++) {
-            target.draw(cells.at(i));
+            sf::Vector2f rectPos = cells.at(i).getRect().getPosition();
+            appendRect(cellQuads, sf::Vector2f(rectPos.x + 1, rectPos.y + 1), sf::Vector2f(CELL_WIDTH - 1, CELL_WIDTH - 1), cells.at(i).getFillColor());
+            const ChessPiece& piece = state->getPiece(i);
+            if (piece.isActive()) {
+                PieceAtlas::appendPiece(pieceQuads, piece, sf::Vector2f(rectPos.x + CELL_WIDTH/2, rectPos.y + CELL_WIDTH/2), DEFAULT_ITEM_SIZE);
+            }
         }
         
-        // Draw captured pieces above/below board
+        // Captured pieces above/below board
         const vector<vector<ChessPiece>>& captures = state->getCaptures();
         for (int i = 0; i < captures.size(); i++) {
-            vector<ChessPiece> cur = captures.at(i);
+            const vector<ChessPiece>& cur = captures.at(i);
             for (int j = 0; j < cur.size(); j++) {
-                ChessPiece piece = cur.at(j);
-                sf::Sprite pieceSprite;
-                sf::Texture texture = piece.getTexture();
-                pieceSprite.setTexture(texture);
-                pieceSprite.setOrigin(sf::Vector2f(texture.getSize().x / 2, texture.getSize().y / 2));
-                pieceSprite.setScale(sf::Vector2f(capSize, capSize));
-                pieceSprite.setPosition(mid + CELL_WIDTH/4 + betweenCaptures * (j % piecesInRow), betweenCaptures + (BOARD_DIM_IN_WINDOW + Y_OFFSET) * i + betweenCaptures * (j/piecesInRow));
-                target.draw(pieceSprite);
+                sf::Vector2f capturePos(mid + CELL_WIDTH/4 + betweenCaptures * (j % piecesInRow), betweenCaptures + (BOARD_DIM_IN_WINDOW + Y_OFFSET) * i + betweenCaptures * (j/piecesInRow));
+                PieceAtlas::appendPiece(pieceQuads, cur.at(j), capturePos, capSize);
             }
         }
+
+        // One draw call for the cells and one for every piece
+        target.draw(cellQuads, states);
+        PieceAtlas::drawQuads(target, pieceQuads, states);
         
         // Draw scores
         for (int i = 0; i < scoreText.size(); i++) {
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <SFML/Graphics.hpp>
+#include "PieceAtlas.h"
 #include "../pieces/ChessPiece.h"
 #include "../pieces/ChessPieceBuilder.h"
 
@@ -30,7 +31,7 @@ public:
 		cellRect.setFillColor((isSelected) ? selectedColor : defaultColor);
 	}
 
-	void setChessPiece(ChessPiece& p) {
+	void setChessPiece(const ChessPiece& p) {
 		piece = p;
 	}
 
@@ -38,11 +39,6 @@ public:
 		return piece;
 	}
 
-	void movePiece(Cell& other) {
-		other.piece = piece;
-		piece = ChessPieceFactory::createPiece(PieceType::EMPTY);
-	}
-
 	void toggleHighlight(sf::Color color = sf::Color::Green) {
 		highlightColor = color;
 		isHighlighted = !isHighlighted;
@@ -66,17 +62,21 @@ public:
 		return cellRect;
 	}
 
+	const sf::RectangleShape& getRect() const {
+		return cellRect;
+	}
+
+	sf::Color getFillColor() const {
+		return cellRect.getFillColor();
+	}
+
 	void draw(sf::RenderTarget& target, sf::RenderStates states) const {
 		target.draw(cellRect);
 		if (piece.isActive()) {
-			sf::Sprite pieceSprite;
-			sf::Texture texture = piece.getTexture();
-			pieceSprite.setTexture(texture);
-			pieceSprite.setOrigin(sf::Vector2f(texture.getSize().x / 2, texture.getSize().y / 2));
-			pieceSprite.setScale(sf::Vector2f(DEFAULT_ITEM_SIZE, DEFAULT_ITEM_SIZE));
 			sf::Vector2f rectPos = cellRect.getPosition();
-			pieceSprite.setPosition(rectPos.x + CELL_WIDTH/2, rectPos.y + CELL_WIDTH/2);
-			target.draw(pieceSprite);
+			sf::VertexArray quad(sf::Quads);
+			PieceAtlas::appendPiece(quad, piece, sf::Vector2f(rectPos.x + CELL_WIDTH/2, rectPos.y + CELL_WIDTH/2), DEFAULT_ITEM_SIZE);
+			PieceAtlas::drawQuads(target, quad, states);
 		}
 	}
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <string>
+#include <algorithm>
+#include <SFML/Graphics.hpp>
+#include "../pieces/ChessPiece.h"
+#include "../constants/Constants.h"
+
+using namespace std;
+
+// Every piece image packed into one texture that is loaded on first use.
+// Pieces refer to their region by sprite index and are drawn as quads, so a
+// whole board of pieces goes out in a single draw call.
+class PieceAtlas {
+private:
+	static const int SPRITES_PER_SIDE = 6;
+
+	struct Atlas {
+		sf::Texture texture;
+		sf::IntRect rects[2 * SPRITES_PER_SIDE];
+	};
+
+	static const Atlas& getAtlas() {
+		static Atlas atlas = load();
+		return atlas;
+	}
+
+	static Atlas load() {
+		const string names[SPRITES_PER_SIDE] = { "pawn", "knight", "bishop", "rook", "queen", "king" };
+		Atlas atlas;
+		sf::Image images[2 * SPRITES_PER_SIDE];
+		unsigned int cellWidth = 0, cellHeight = 0;
+		for (int i = 0; i < 2 * SPRITES_PER_SIDE; i++) {
+			images[i].loadFromFile(TEXTURE_PATH + ((i / SPRITES_PER_SIDE) ? "b_" : "w_") + names[i % SPRITES_PER_SIDE] + ".png");
+			cellWidth = max(cellWidth, images[i].getSize().x);
+			cellHeight = max(cellHeight, images[i].getSize().y);
+		}
+
+		// One row per side, one column per piece type
+		sf::Image sheet;
+		sheet.create(cellWidth * SPRITES_PER_SIDE, cellHeight * 2, sf::Color::Transparent);
+		for (int i = 0; i < 2 * SPRITES_PER_SIDE; i++) {
+			int x = cellWidth * (i % SPRITES_PER_SIDE);
+			int y = cellHeight * (i / SPRITES_PER_SIDE);
+			sheet.copy(images[i], x, y);
+			atlas.rects[i] = sf::IntRect(x, y, images[i].getSize().x, images[i].getSize().y);
+		}
+		atlas.texture.loadFromImage(sheet);
+		atlas.texture.setSmooth(true);
+		return atlas;
+	}
+
+public:
+	static int getSpriteIndex(const ChessPiece& piece) {
+		return ((piece.getSide() == PieceSide::BLACK) ? SPRITES_PER_SIDE : 0) + (int)piece.getType() - (int)PieceType::PAWN;
+	}
+
+	static const sf::Texture& getTexture() {
+		return getAtlas().texture;
+	}
+
+	// Adds the piece as a textured quad centered on the given point
+	static void appendPiece(sf::VertexArray& quads, const ChessPiece& piece, sf::Vector2f center, float scale) {
+		const sf::IntRect& rect = getAtlas().rects[getSpriteIndex(piece)];
+		float halfWidth = rect.width * scale / 2.f;
+		float halfHeight = rect.height * scale / 2.f;
+		float left = (float)rect.left, top = (float)rect.top;
+		float right = left + rect.width, bottom = top + rect.height;
+		quads.append(sf::Vertex(sf::Vector2f(center.x - halfWidth, center.y - halfHeight), sf::Vector2f(left, top)));
+		quads.append(sf::Vertex(sf::Vector2f(center.x + halfWidth, center.y - halfHeight), sf::Vector2f(right, top)));
+		quads.append(sf::Vertex(sf::Vector2f(center.x + halfWidth, center.y + halfHeight), sf::Vector2f(right, bottom)));
+		quads.append(sf::Vertex(sf::Vector2f(center.x - halfWidth, center.y + halfHeight), sf::Vector2f(left, bottom)));
+	}
+
+	static void drawQuads(sf::RenderTarget& target, const sf::VertexArray& quads, sf::RenderStates states = sf::RenderStates::Default) {
+		states.texture = &getTexture();
+		target.draw(quads, states);
+	}
+};
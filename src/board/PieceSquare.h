@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Bitboard.h"
+#include <cstdint>
+#include <mutex>
+
+using namespace std;
+
+// Material plus piece-square values for the middlegame and the endgame,
+// signed for white. The board adds and removes them as pieces are placed,
+// so the sums for a position are always at hand.
+class PieceSquare {
+public:
+    static constexpr int MAX_PHASE = 24; // all minor pieces, rooks and queens on the board
+
+private:
+    static once_flag initializedFlag;
+    static int middlegame[2][7][64]; // [side][PieceType][square]
+    static int endgame[2][7][64];
+    static const int phaseWeights[7];
+
+    // Tables written from white's side with the eighth rank first, as on a diagram
+    static const int16_t middlegameValues[7];
+    static const int16_t endgameValues[7];
+    static const int16_t middlegameTables[7][64];
+    static const int16_t endgameTables[7][64];
+
+    static void build() {
+        for (int type = 0; type < 7; type++) {
+            for (int pos = 0; pos < 64; pos++) {
+                // White reads the diagram upside down, black reads it as is
+                middlegame[0][type][pos] = middlegameValues[type] + middlegameTables[type][pos ^ 56];
+                endgame[0][type][pos] = endgameValues[type] + endgameTables[type][pos ^ 56];
+                middlegame[1][type][pos] = -(middlegameValues[type] + middlegameTables[type][pos]);
+                endgame[1][type][pos] = -(endgameValues[type] + endgameTables[type][pos]);
+            }
+        }
+    }
+
+public:
+    // Safe to call from any thread, the tables are built by the first caller
+    static void initialize() {
+        call_once(initializedFlag, build);
+    }
+
+    static int getMiddlegame(PieceType type, PieceSide side, int pos) { return middlegame[sideIndex(side)][(int)type][pos]; }
+    static int getEndgame(PieceType type, PieceSide side, int pos) { return endgame[sideIndex(side)][(int)type][pos]; }
+    static int getPhase(PieceType type) { return phaseWeights[(int)type]; }
+};
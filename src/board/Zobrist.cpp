@@ -0,0 +1,7 @@
+#include "Zobrist.h"
+
+once_flag Zobrist::initializedFlag;
+uint64_t Zobrist::pieceKeys[2][7][64];
+uint64_t Zobrist::sideKey;
+uint64_t Zobrist::castlingKeys[16];
+uint64_t Zobrist::enPassantKeys[BOARD_WIDTH];
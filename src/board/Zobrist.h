@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Bitboard.h"
+#include <cstdint>
+#include <mutex>
+
+using namespace std;
+
+// Random keys XORed together into a position hash. A key is included for
+// each piece on its square, the side to move, the castling rights and the
+// file of the en passant square, so each change toggles exactly one key.
+class Zobrist {
+private:
+    static once_flag initializedFlag;
+    static uint64_t pieceKeys[2][7][64]; // [side][PieceType][square]
+    static uint64_t sideKey;
+    static uint64_t castlingKeys[16];
+    static uint64_t enPassantKeys[BOARD_WIDTH];
+
+    // splitmix64, seeded with a constant so keys are the same on every run
+    static uint64_t nextRandom(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static void build() {
+        uint64_t state = 0x2545F4914F6CDD1DULL;
+        for (int side = 0; side < 2; side++) {
+            for (int type = 0; type < 7; type++) {
+                for (int pos = 0; pos < 64; pos++) {
+                    pieceKeys[side][type][pos] = (type == (int)PieceType::EMPTY) ? 0 : nextRandom(state);
+                }
+            }
+        }
+        sideKey = nextRandom(state);
+        for (uint64_t& key : castlingKeys) {
+            key = nextRandom(state);
+        }
+        for (uint64_t& key : enPassantKeys) {
+            key = nextRandom(state);
+        }
+    }
+
+public:
+    // The keys are drawn once, by whichever thread gets here first
+    static void initialize() {
+        call_once(initializedFlag, build);
+    }
+
+    static uint64_t getPieceKey(PieceType type, PieceSide side, int pos) { return pieceKeys[sideIndex(side)][(int)type][pos]; }
+    static uint64_t getSideKey() { return sideKey; }
+    static uint64_t getCastlingKey(int rights) { return castlingKeys[rights]; }
+
+    // No key when there is no en passant square
+    static uint64_t getEnPassantKey(int pos) {
+        return (pos == NONE_SELECTED) ? 0 : enPassantKeys[pos % BOARD_WIDTH];
+    }
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <string>
 
 const int BOARD_HEIGHT = 8;
 const int BOARD_WIDTH = 8;
@@ -8,6 +9,8 @@ const float BUTTON_SIZE = 128;
 const int BUTTON_OUTLINE_WIDTH = 5;
 const int BUTTON_CHARSIZE = 32;
 const int TITLE_CHARSIZE = 48;
+const int DEFAULT_MAX_FPS = 60; // Chess --fps, 0 for vsync only
+const double ENGINE_MOVE_SECONDS = 1.0; // Chess, search time when space asks the engine to move
 
 const int NONE_SELECTED = -10;
 const int Y_OFFSET = 128;
@@ -16,9 +19,19 @@ const int BOARD_DIM_IN_WINDOW = 512;
 const int CELL_WIDTH = 64;
 const float DEFAULT_ITEM_SIZE = 0.375;
 
-const int MAX_RANGE = 8;
+// Castling rights bits kept by Board
+const int CASTLE_WHITE_KINGSIDE = 1;
+const int CASTLE_WHITE_QUEENSIDE = 2;
+const int CASTLE_BLACK_KINGSIDE = 4;
+const int CASTLE_BLACK_QUEENSIDE = 8;
+const int CASTLE_ALL = 15;
+
+const int MAX_GAME_PLY = 1024;
+const std::string START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+const int DEFAULT_HASH_MEGABYTES = 16;
 
 const std::string ASSET_PATH = "assets/";
 const std::string TEXTURE_PATH = ASSET_PATH + "/textures/";
 const std::string AUDIO_PATH = ASSET_PATH + "/sounds/";
-const std::string FONT_PATH = ASSET_PATH + "/fonts/";
\ No newline at end of file
+const std::string FONT_PATH = ASSET_PATH + "/fonts/";
+const std::string BOOK_PATH = ASSET_PATH + "/book/";
\ No newline at end of file
@@ -1,8 +1,8 @@
 #pragma once
-#include <SFML/Graphics.hpp>
+#include <cstdint>
 
 // Move existing enums from Constants.h
-enum class PieceType {
+enum class PieceType : uint8_t {
     EMPTY = 0,
     PAWN = 1,
     KNIGHT = 2,
@@ -23,7 +23,10 @@ enum class GameState {
     CHECK,
     CHECKMATE, 
     STALEMATE, 
-    NO_TURN 
+    NO_TURN,
+    TABLEBASE_WIN,  // proven by the endgame tablebase for the side to move
+    TABLEBASE_DRAW,
+    TABLEBASE_LOSS
 };
 
 enum class WindowState { 
@@ -37,4 +40,32 @@ enum class MoveDirection {
     VERTICAL,
     DIAGONAL_LEFT,
     DIAGONAL_RIGHT
-};
\ No newline at end of file
+};
+
+// How a stored search score relates to the true score of the position
+enum class Bound : uint8_t {
+    NONE,
+    UPPER,
+    LOWER,
+    EXACT
+};
+
+// How AttackTables looks up bishop and rook attacks
+enum class SliderMode {
+    RAYS,
+    MAGIC,
+    PEXT
+};
+
+// Vector instructions used by the Nnue kernels, the best the CPU has by default
+enum class SimdMode {
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+// How an opening book move is chosen among the entries for a position
+enum class BookSelection {
+    BEST,    // highest weight
+    WEIGHTED // random, in proportion to weight
+};
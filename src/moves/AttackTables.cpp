@@ -0,0 +1,13 @@
+#include "AttackTables.h"
+
+once_flag AttackTables::initializedFlag;
+Bitboard AttackTables::rays[AttackTables::RAY_COUNT][64];
+Bitboard AttackTables::between[64][64];
+Bitboard AttackTables::lines[64][64];
+AttackTables::SliderTable AttackTables::rookTables[64];
+AttackTables::SliderTable AttackTables::bishopTables[64];
+Bitboard AttackTables::rookAttacks[AttackTables::ROOK_TABLE_SIZE];
+Bitboard AttackTables::bishopAttacks[AttackTables::BISHOP_TABLE_SIZE];
+Bitboard AttackTables::rookPextAttacks[AttackTables::ROOK_TABLE_SIZE];
+Bitboard AttackTables::bishopPextAttacks[AttackTables::BISHOP_TABLE_SIZE];
+SliderMode AttackTables::sliderMode = (AttackTables::isPextSupported()) ? SliderMode::PEXT : SliderMode::MAGIC;
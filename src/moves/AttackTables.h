@@ -0,0 +1,258 @@
+#pragma once
+
+#include "../board/Bitboard.h"
+#include "LeaperTables.h"
+#include <vector>
+#include <mutex>
+// PEXT lookups are only compiled in when the whole build targets BMI2
+// (CHESS_BMI2 in CMake), so _pext_u64 inlines into the move generator
+#if defined(__BMI2__) || (defined(_M_X64) && defined(__AVX2__))
+#include <immintrin.h>
+#define CHESS_HAS_PEXT
+#endif
+
+using namespace std;
+
+// Precomputed attack masks for every square. Leaper masks come from the
+// compile time LeaperTables. Sliders are looked up in magic or PEXT
+// indexed tables, or walked along rays cut at the first blocker. PEXT is
+// the default in builds for BMI2 and not available in others.
+class AttackTables {
+private:
+    // Ray order: each MoveDirection owns two rays, positive step first
+    static const int RAY_COUNT = 8;
+    static const int ROOK_TABLE_SIZE = 102400;
+    static const int BISHOP_TABLE_SIZE = 5248;
+
+    // Attacks of one slider on one square for every occupancy of its relevant squares
+    struct SliderTable {
+        Bitboard mask; // squares whose occupancy changes the attacks, edges excluded
+        Bitboard magic;
+        int shift;
+        Bitboard* attacks;     // indexed by ((occupied & mask) * magic) >> shift
+        Bitboard* pextAttacks; // indexed by pext(occupied, mask)
+    };
+
+    static once_flag initializedFlag;
+    static Bitboard rays[RAY_COUNT][64];
+    static Bitboard between[64][64];
+    static Bitboard lines[64][64];
+    static SliderTable rookTables[64];
+    static SliderTable bishopTables[64];
+    static Bitboard rookAttacks[ROOK_TABLE_SIZE];
+    static Bitboard bishopAttacks[BISHOP_TABLE_SIZE];
+    static Bitboard rookPextAttacks[ROOK_TABLE_SIZE];
+    static Bitboard bishopPextAttacks[BISHOP_TABLE_SIZE];
+    static SliderMode sliderMode;
+
+    static Bitboard buildRay(int pos, int fileStep, int rankStep) {
+        Bitboard ray = EMPTY_BITBOARD;
+        int file = pos % BOARD_WIDTH + fileStep;
+        int rank = pos / BOARD_WIDTH + rankStep;
+        while (file >= 0 && file < BOARD_WIDTH && rank >= 0 && rank < BOARD_HEIGHT) {
+            ray |= squareBit(rank * BOARD_WIDTH + file);
+            file += fileStep;
+            rank += rankStep;
+        }
+        return ray;
+    }
+
+    static Bitboard rayAttacks(int pos, int ray, Bitboard occupied) {
+        Bitboard attacks = rays[ray][pos];
+        Bitboard blockers = attacks & occupied;
+        if (blockers) {
+            attacks ^= rays[ray][(ray % 2 == 0) ? lsb(blockers) : msb(blockers)];
+        }
+        return attacks;
+    }
+
+    static Bitboard rayBishopAttacks(int pos, Bitboard occupied) {
+        return rayAttacks(pos, 4, occupied) | rayAttacks(pos, 5, occupied) | rayAttacks(pos, 6, occupied) | rayAttacks(pos, 7, occupied);
+    }
+
+    static Bitboard rayRookAttacks(int pos, Bitboard occupied) {
+        return rayAttacks(pos, 0, occupied) | rayAttacks(pos, 1, occupied) | rayAttacks(pos, 2, occupied) | rayAttacks(pos, 3, occupied);
+    }
+
+#ifdef CHESS_HAS_PEXT
+    static Bitboard pext(Bitboard value, Bitboard mask) {
+        return _pext_u64(value, mask);
+    }
+#else
+    static Bitboard pext(Bitboard, Bitboard) {
+        return 0;
+    }
+#endif
+
+    // xorshift64*, seeded per rank with values known to find magics quickly
+    static Bitboard nextRandom(Bitboard& state) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    // Fills the tables of one slider, rays from firstRay to firstRay + 3, starting at the given storage
+    static void initSlider(SliderTable tables[], int firstRay, Bitboard* attacks, Bitboard* pextAttacks) {
+        static Bitboard occupancies[4096];
+        static Bitboard reference[4096];
+        static int epoch[4096];
+        static int attempt = 0; // kept across calls so epochs from earlier squares never match
+        const Bitboard seeds[BOARD_HEIGHT] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+        bool withPext = isPextSupported();
+
+        for (int pos = 0; pos < 64; pos++) {
+            SliderTable& table = tables[pos];
+            table.mask = EMPTY_BITBOARD;
+            for (int r = firstRay; r < firstRay + 4; r++) {
+                Bitboard ray = rays[r][pos];
+                if (ray) {
+                    table.mask |= ray & ~squareBit((r % 2 == 0) ? msb(ray) : lsb(ray));
+                }
+            }
+            int bits = popCount(table.mask);
+            int size = 1 << bits;
+            table.shift = 64 - bits;
+            table.attacks = attacks;
+            table.pextAttacks = pextAttacks;
+            attacks += size;
+            pextAttacks += size;
+
+            // Every subset of the mask, walked with the carry-rippler trick
+            Bitboard subset = EMPTY_BITBOARD;
+            for (int i = 0; i < size; i++) {
+                occupancies[i] = subset;
+                reference[i] = (firstRay == 0) ? rayRookAttacks(pos, subset) : rayBishopAttacks(pos, subset);
+                if (withPext) {
+                    table.pextAttacks[pext(subset, table.mask)] = reference[i];
+                }
+                subset = (subset - table.mask) & table.mask;
+            }
+
+            // Sparse random candidates until one maps every occupancy without a harmful collision
+            Bitboard random = seeds[pos / BOARD_WIDTH];
+            bool found = false;
+            while (!found) {
+                table.magic = nextRandom(random) & nextRandom(random) & nextRandom(random);
+                if (popCount((table.mask * table.magic) >> 56) < 6) {
+                    continue;
+                }
+                attempt++;
+                found = true;
+                for (int i = 0; i < size && found; i++) {
+                    int index = (int)(((occupancies[i] & table.mask) * table.magic) >> table.shift);
+                    if (epoch[index] < attempt) {
+                        epoch[index] = attempt;
+                        table.attacks[index] = reference[i];
+                    }
+                    else if (table.attacks[index] != reference[i]) {
+                        found = false;
+                    }
+                }
+            }
+        }
+    }
+
+    static Bitboard magicAttacks(const SliderTable& table, Bitboard occupied) {
+        return table.attacks[((occupied & table.mask) * table.magic) >> table.shift];
+    }
+
+    static void build() {
+        // {file step, rank step} for the positive and negative ray of each MoveDirection
+        const int raySteps[RAY_COUNT][2] = {
+            { 1, 0 }, { -1, 0 },  // HORIZONTAL
+            { 0, 1 }, { 0, -1 },  // VERTICAL
+            { 1, 1 }, { -1, -1 }, // DIAGONAL_LEFT
+            { -1, 1 }, { 1, -1 }  // DIAGONAL_RIGHT
+        };
+
+        for (int pos = 0; pos < BOARD_WIDTH * BOARD_HEIGHT; pos++) {
+            for (int other = 0; other < BOARD_WIDTH * BOARD_HEIGHT; other++) {
+                between[pos][other] = lines[pos][other] = EMPTY_BITBOARD;
+            }
+        }
+
+        for (int pos = 0; pos < BOARD_WIDTH * BOARD_HEIGHT; pos++) {
+            for (int r = 0; r < RAY_COUNT; r++) {
+                rays[r][pos] = buildRay(pos, raySteps[r][0], raySteps[r][1]);
+            }
+        }
+
+        // Squares strictly between two aligned squares, and the full line through them
+        for (int pos = 0; pos < BOARD_WIDTH * BOARD_HEIGHT; pos++) {
+            for (int r = 0; r < RAY_COUNT; r++) {
+                Bitboard line = rays[r][pos] | rays[r ^ 1][pos] | squareBit(pos);
+                Bitboard ray = rays[r][pos];
+                while (ray) {
+                    int other = popLsb(ray);
+                    between[pos][other] = rays[r][pos] & ~rays[r][other] & ~squareBit(other);
+                    lines[pos][other] = line;
+                }
+            }
+        }
+
+        initSlider(rookTables, 0, rookAttacks, rookPextAttacks);
+        initSlider(bishopTables, 4, bishopAttacks, bishopPextAttacks);
+    }
+
+public:
+    // Every generator calls this, possibly from several search threads at once
+    static void initialize() {
+        call_once(initializedFlag, build);
+    }
+
+    static Bitboard getKnightAttacks(int pos) { return LeaperTables::knight[pos]; }
+    static Bitboard getKingAttacks(int pos) { return LeaperTables::king[pos]; }
+    static Bitboard getPawnAttacks(PieceSide side, int pos) { return LeaperTables::pawn[sideIndex(side)][pos]; }
+
+    static Bitboard getBetween(int from, int to) { return between[from][to]; }
+    static Bitboard getLine(int from, int to) { return lines[from][to]; }
+
+    static Bitboard getBishopAttacks(int pos, Bitboard occupied) {
+        switch (sliderMode) {
+            case SliderMode::MAGIC: return magicAttacks(bishopTables[pos], occupied);
+            case SliderMode::PEXT: return bishopTables[pos].pextAttacks[pext(occupied, bishopTables[pos].mask)];
+            default: return rayBishopAttacks(pos, occupied);
+        }
+    }
+
+    static Bitboard getRookAttacks(int pos, Bitboard occupied) {
+        switch (sliderMode) {
+            case SliderMode::MAGIC: return magicAttacks(rookTables[pos], occupied);
+            case SliderMode::PEXT: return rookTables[pos].pextAttacks[pext(occupied, rookTables[pos].mask)];
+            default: return rayRookAttacks(pos, occupied);
+        }
+    }
+
+    static constexpr bool isPextSupported() {
+#ifdef CHESS_HAS_PEXT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // False, with the mode left as it was, for PEXT in builds without BMI2
+    static bool setSliderMode(SliderMode mode) {
+        if (mode == SliderMode::PEXT && !isPextSupported()) {
+            return false;
+        }
+        sliderMode = mode;
+        return true;
+    }
+
+    static SliderMode getSliderMode() { return sliderMode; }
+
+    // Squares attacked by a piece of the given type and side standing on pos
+    static Bitboard getAttacks(PieceType type, PieceSide side, int pos, Bitboard occupied) {
+        switch (type) {
+            case PieceType::PAWN: return getPawnAttacks(side, pos);
+            case PieceType::KNIGHT: return getKnightAttacks(pos);
+            case PieceType::BISHOP: return getBishopAttacks(pos, occupied);
+            case PieceType::ROOK: return getRookAttacks(pos, occupied);
+            case PieceType::QUEEN: return getBishopAttacks(pos, occupied) | getRookAttacks(pos, occupied);
+            case PieceType::KING: return getKingAttacks(pos);
+            default: return EMPTY_BITBOARD;
+        }
+    }
+};
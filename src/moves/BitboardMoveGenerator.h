@@ -0,0 +1,270 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "AttackTables.h"
+#include "MoveList.h"
+
+// Computed once per position and side: what is giving check, which squares
+// resolve it, and which pieces may only move along the line to their king
+struct CheckInfo {
+    int kingPos;
+    Bitboard checkers;
+    Bitboard checkMask;
+    Bitboard pinned;
+};
+
+// Move generation on the bitboards kept by Board. Moves for a piece come back
+// as a mask of target squares.
+class BitboardMoveGenerator {
+private:
+    Board* state;
+
+    int pawnStep(PieceSide side) const {
+        return (side == PieceSide::WHITE) ? state->getWidth() : -state->getWidth();
+    }
+
+    Bitboard pawnPushes(int pos, PieceSide side, Bitboard occupied) const {
+        int step = pawnStep(side);
+        int startRank = (side == PieceSide::WHITE) ? 1 : state->getHeight() - 2;
+        int oneStep = pos + step;
+        if (oneStep < 0 || oneStep >= state->size() || testBit(occupied, oneStep)) {
+            return EMPTY_BITBOARD;
+        }
+        Bitboard pushes = squareBit(oneStep);
+        if (pos / state->getWidth() == startRank && !testBit(occupied, oneStep + step)) {
+            pushes |= squareBit(oneStep + step);
+        }
+        return pushes;
+    }
+
+    // En passant target usable by a pawn of the given side, if any
+    Bitboard enPassantTarget(PieceSide side) const {
+        int target = state->getEnPassantMove();
+        if (target == NONE_SELECTED) {
+            return EMPTY_BITBOARD;
+        }
+        int victim = target - pawnStep(side);
+        const BitboardPosition& bb = state->getBitboards();
+        return testBit(bb.getPieces(PieceType::PAWN, oppositeSide(side)), victim) ? squareBit(target) : EMPTY_BITBOARD;
+    }
+
+    bool isAttacked(int pos, PieceSide bySide) const {
+        return state->getAttackMap().isSquareAttacked(pos, bySide);
+    }
+
+    Bitboard slidingPieces() const {
+        const BitboardPosition& bb = state->getBitboards();
+        return bb.getPieces(PieceType::BISHOP) | bb.getPieces(PieceType::ROOK) | bb.getPieces(PieceType::QUEEN);
+    }
+
+    // Squares the king may step to: not attacked, and not further along the ray
+    // of a sliding checker, which the attack map sees as blocked by the king
+    Bitboard getKingMoves(int kingPos, PieceSide side, Bitboard checkers) const {
+        const BitboardPosition& bb = state->getBitboards();
+        PieceSide enemy = oppositeSide(side);
+        Bitboard danger = state->getAttackMap().getAttacks(enemy);
+        Bitboard withoutKing = bb.getOccupied() & ~squareBit(kingPos);
+        Bitboard slidingCheckers = checkers & slidingPieces();
+        while (slidingCheckers) {
+            int pos = popLsb(slidingCheckers);
+            danger |= AttackTables::getAttacks(bb.getTypeAt(pos), enemy, pos, withoutKing);
+        }
+        return AttackTables::getKingAttacks(kingPos) & ~bb.getOccupied(side) & ~danger;
+    }
+
+    bool promotes(int to, PieceSide side) const {
+        int rank = to / state->getWidth();
+        return (side == PieceSide::WHITE) ? rank == state->getHeight() - 1 : rank == 0;
+    }
+
+public:
+    BitboardMoveGenerator(Board* state) : state(state) {
+        AttackTables::initialize();
+    }
+
+    // Pieces of a side attacking pos, with sliders seeing through the given occupancy
+    Bitboard attackersTo(int pos, PieceSide side, Bitboard occupied) const {
+        const BitboardPosition& bb = state->getBitboards();
+        Bitboard queens = bb.getPieces(PieceType::QUEEN, side);
+        return (AttackTables::getPawnAttacks(oppositeSide(side), pos) & bb.getPieces(PieceType::PAWN, side))
+            | (AttackTables::getKnightAttacks(pos) & bb.getPieces(PieceType::KNIGHT, side))
+            | (AttackTables::getKingAttacks(pos) & bb.getPieces(PieceType::KING, side))
+            | (AttackTables::getBishopAttacks(pos, occupied) & (bb.getPieces(PieceType::BISHOP, side) | queens))
+            | (AttackTables::getRookAttacks(pos, occupied) & (bb.getPieces(PieceType::ROOK, side) | queens));
+    }
+
+    bool isInCheck(PieceSide side) const {
+        int kingPos = state->getBitboards().getKingPos(side);
+        return kingPos != NONE_SELECTED && isAttacked(kingPos, oppositeSide(side));
+    }
+
+    // Moves for the piece on pos ignoring whether its own king is left in check
+    Bitboard getPseudoLegalMoves(int pos) const {
+        const BitboardPosition& bb = state->getBitboards();
+        ChessPiece& piece = state->getPiece(pos);
+        if (!piece.isActive()) {
+            return EMPTY_BITBOARD;
+        }
+        PieceSide side = piece.getSide();
+        Bitboard occupied = bb.getOccupied();
+        if (piece.isOfType(PieceType::PAWN)) {
+            Bitboard captures = AttackTables::getPawnAttacks(side, pos) & (bb.getOccupied(oppositeSide(side)) | enPassantTarget(side));
+            return pawnPushes(pos, side, occupied) | captures;
+        }
+        return AttackTables::getAttacks(piece.getType(), side, pos, occupied) & ~bb.getOccupied(side);
+    }
+
+    // Play the move on a copy of the occupancy and test the mover's king
+    bool leavesKingInCheck(int from, int to) const {
+        const BitboardPosition& bb = state->getBitboards();
+        ChessPiece& piece = state->getPiece(from);
+        PieceSide side = piece.getSide();
+        PieceSide enemy = oppositeSide(side);
+        Bitboard captured = squareBit(to) & bb.getOccupied(enemy);
+        if (piece.isOfType(PieceType::PAWN) && (squareBit(to) & enPassantTarget(side))) {
+            captured = squareBit(to - pawnStep(side));
+        }
+        Bitboard occupied = ((bb.getOccupied() & ~squareBit(from)) & ~captured) | squareBit(to);
+        int kingPos = (piece.isOfType(PieceType::KING)) ? to : bb.getKingPos(side);
+        return (attackersTo(kingPos, enemy, occupied) & ~captured) != EMPTY_BITBOARD;
+    }
+
+    // Castling targets allowed by the board's castling rights: path empty, rook
+    // in place, and no square the king stands on or crosses is attacked
+    Bitboard getCastleMoves(int kingPos) const {
+        const ChessPiece& king = state->getPiece(kingPos);
+        Bitboard castleMoves = EMPTY_BITBOARD;
+        if (!king.isOfType(PieceType::KING)) {
+            return castleMoves;
+        }
+        PieceSide side = king.getSide();
+        PieceSide enemy = oppositeSide(side);
+        int rights = state->getCastlingRights() & ((side == PieceSide::WHITE)
+            ? CASTLE_WHITE_KINGSIDE | CASTLE_WHITE_QUEENSIDE : CASTLE_BLACK_KINGSIDE | CASTLE_BLACK_QUEENSIDE);
+        if (!rights || isAttacked(kingPos, enemy)) {
+            return castleMoves;
+        }
+        const BitboardPosition& bb = state->getBitboards();
+        Bitboard occupied = bb.getOccupied();
+        Bitboard rooks = bb.getPieces(PieceType::ROOK, side);
+        const int distances[] = { 3, 4 };
+        for (int i = 0; i < 2; i++) {
+            int step = -2 * i + 1;
+            int dist = distances[i];
+            int rookPos = kingPos + step * dist;
+            bool canCastle = rookPos >= 0 && rookPos < state->size() && (rights & state->castlingRightsAt(rookPos)) && testBit(rooks, rookPos);
+            for (int j = 1; j < dist && canCastle; j++) {
+                canCastle = !testBit(occupied, kingPos + step * j);
+            }
+            for (int j = 1; j <= 2 && canCastle; j++) {
+                canCastle = !isAttacked(kingPos + step * j, enemy);
+            }
+            if (canCastle) {
+                castleMoves |= squareBit(kingPos + 2 * step);
+            }
+        }
+        return castleMoves;
+    }
+
+    CheckInfo getCheckInfo(PieceSide side) const {
+        const BitboardPosition& bb = state->getBitboards();
+        PieceSide enemy = oppositeSide(side);
+        Bitboard occupied = bb.getOccupied();
+        CheckInfo info;
+        info.kingPos = bb.getKingPos(side);
+        info.checkers = EMPTY_BITBOARD;
+        info.checkMask = ~EMPTY_BITBOARD;
+        info.pinned = EMPTY_BITBOARD;
+        if (info.kingPos == NONE_SELECTED) {
+            return info;
+        }
+
+        info.checkers = attackersTo(info.kingPos, enemy, occupied);
+        if (popCount(info.checkers) > 1) {
+            info.checkMask = EMPTY_BITBOARD;
+        }
+        else if (info.checkers) {
+            int checker = lsb(info.checkers);
+            info.checkMask = info.checkers | AttackTables::getBetween(info.kingPos, checker);
+        }
+
+        // Enemy sliders aimed at the king with exactly one of our pieces in between
+        Bitboard queens = bb.getPieces(PieceType::QUEEN, enemy);
+        Bitboard snipers = (AttackTables::getRookAttacks(info.kingPos, EMPTY_BITBOARD) & (bb.getPieces(PieceType::ROOK, enemy) | queens))
+            | (AttackTables::getBishopAttacks(info.kingPos, EMPTY_BITBOARD) & (bb.getPieces(PieceType::BISHOP, enemy) | queens));
+        while (snipers) {
+            Bitboard blockers = AttackTables::getBetween(info.kingPos, popLsb(snipers)) & occupied;
+            if (popCount(blockers) == 1) {
+                info.pinned |= blockers & bb.getOccupied(side);
+            }
+        }
+        return info;
+    }
+
+    // Legal targets by masking: evasions through the check mask, pinned pieces
+    // kept on their pin line. En passant can uncover a check along the rank the
+    // two pawns leave, so that one capture is verified on the occupancy instead.
+    Bitboard getLegalMoves(int pos, const CheckInfo& info) const {
+        const ChessPiece& piece = state->getPiece(pos);
+        if (!piece.isActive()) {
+            return EMPTY_BITBOARD;
+        }
+        PieceSide side = piece.getSide();
+        if (piece.isOfType(PieceType::KING)) {
+            Bitboard kingMoves = getKingMoves(pos, side, info.checkers);
+            return (info.checkers) ? kingMoves : kingMoves | getCastleMoves(pos);
+        }
+        if (!info.checkMask) {
+            return EMPTY_BITBOARD;
+        }
+        Bitboard moves = getPseudoLegalMoves(pos);
+        Bitboard enPassant = (piece.isOfType(PieceType::PAWN)) ? moves & enPassantTarget(side) : EMPTY_BITBOARD;
+        moves &= ~enPassant & info.checkMask;
+        if (testBit(info.pinned, pos)) {
+            moves &= AttackTables::getLine(info.kingPos, pos);
+        }
+        if (enPassant && !leavesKingInCheck(pos, lsb(enPassant))) {
+            moves |= enPassant;
+        }
+        return moves;
+    }
+
+    Bitboard getLegalMoves(int pos) const {
+        return getLegalMoves(pos, getCheckInfo(state->getPiece(pos).getSide()));
+    }
+
+    // All legal moves for the side to move, with one entry per promotion piece
+    void generateLegalMoves(MoveList& moves) const {
+        const PieceType promotionTypes[] = { PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT };
+        PieceSide side = state->getSideToMove();
+        CheckInfo info = getCheckInfo(side);
+        Bitboard pawns = state->getBitboards().getPieces(PieceType::PAWN, side);
+        Bitboard pieces = state->getBitboards().getOccupied(side);
+        while (pieces) {
+            int from = popLsb(pieces);
+            Bitboard targets = getLegalMoves(from, info);
+            while (targets) {
+                int to = popLsb(targets);
+                if (testBit(pawns, from) && promotes(to, side)) {
+                    for (PieceType type : promotionTypes) {
+                        moves.add(Move(from, to, type));
+                    }
+                }
+                else {
+                    moves.add(Move(from, to));
+                }
+            }
+        }
+    }
+
+    bool hasLegalMoves(PieceSide side) const {
+        CheckInfo info = getCheckInfo(side);
+        Bitboard pieces = state->getBitboards().getOccupied(side);
+        while (pieces) {
+            if (getLegalMoves(popLsb(pieces), info)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
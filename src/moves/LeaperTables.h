@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../board/Bitboard.h"
+#include <array>
+#include <cstddef>
+
+typedef std::array<Bitboard, BOARD_WIDTH * BOARD_HEIGHT> SquareTable;
+
+// Squares reached from every square by {file, rank} steps, dropping steps that
+// leave the board so nothing can wrap around an edge
+template <size_t N>
+constexpr SquareTable buildLeaperTable(const int (&steps)[N][2]) {
+    SquareTable table = {};
+    for (int pos = 0; pos < BOARD_WIDTH * BOARD_HEIGHT; pos++) {
+        for (size_t i = 0; i < N; i++) {
+            int file = pos % BOARD_WIDTH + steps[i][0];
+            int rank = pos / BOARD_WIDTH + steps[i][1];
+            if (file >= 0 && file < BOARD_WIDTH && rank >= 0 && rank < BOARD_HEIGHT) {
+                table[pos] |= squareBit(rank * BOARD_WIDTH + file);
+            }
+        }
+    }
+    return table;
+}
+
+constexpr int KNIGHT_STEPS[8][2] = { { 1, 2 }, { 2, 1 }, { 2, -1 }, { 1, -2 }, { -1, -2 }, { -2, -1 }, { -2, 1 }, { -1, 2 } };
+constexpr int KING_STEPS[8][2] = { { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 } };
+constexpr int WHITE_PAWN_CAPTURES[2][2] = { { -1, 1 }, { 1, 1 } };
+constexpr int BLACK_PAWN_CAPTURES[2][2] = { { -1, -1 }, { 1, -1 } };
+
+// Knight, king and pawn capture masks, computed by the compiler
+class LeaperTables {
+public:
+    static constexpr SquareTable knight = buildLeaperTable(KNIGHT_STEPS);
+    static constexpr SquareTable king = buildLeaperTable(KING_STEPS);
+    static constexpr SquareTable pawn[2] = { buildLeaperTable(WHITE_PAWN_CAPTURES), buildLeaperTable(BLACK_PAWN_CAPTURES) }; // indexed by sideIndex
+};
+
+static_assert(LeaperTables::knight[0] == (squareBit(10) | squareBit(17)), "Knight on a1 attacks c2 and b3");
+static_assert(LeaperTables::king[7] == (squareBit(6) | squareBit(14) | squareBit(15)), "King on h1 attacks g1, g2 and h2");
+static_assert(LeaperTables::pawn[1][8] == squareBit(1), "Black pawn on a2 attacks b1 only");
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../constants/Constants.h"
+#include "../constants/Enums.h"
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// A move between two board positions, with the piece chosen on promotion.
+// Kept to three bytes so move lists stay small.
+struct Move {
+    int8_t from;
+    int8_t to;
+    PieceType promotion;
+
+    Move() : from(NONE_SELECTED), to(NONE_SELECTED), promotion(PieceType::EMPTY) {}
+    Move(int from, int to, PieceType promotion = PieceType::EMPTY) : from((int8_t)from), to((int8_t)to), promotion(promotion) {}
+
+    bool isValid() const {
+        return from != NONE_SELECTED && to != NONE_SELECTED;
+    }
+
+    bool operator==(const Move& other) const {
+        return from == other.from && to == other.to && promotion == other.promotion;
+    }
+
+    bool operator!=(const Move& other) const {
+        return !(*this == other);
+    }
+
+    static string squareName(int pos) {
+        string name;
+        name += (char)('a' + pos % BOARD_WIDTH);
+        name += (char)('1' + pos / BOARD_WIDTH);
+        return name;
+    }
+
+    // Board position for a square name like "e4", NONE_SELECTED if malformed
+    static int parseSquare(const string& name) {
+        if (name.size() != 2) {
+            return NONE_SELECTED;
+        }
+        int file = name[0] - 'a';
+        int rank = name[1] - '1';
+        if (file < 0 || file >= BOARD_WIDTH || rank < 0 || rank >= BOARD_HEIGHT) {
+            return NONE_SELECTED;
+        }
+        return rank * BOARD_WIDTH + file;
+    }
+
+    // Coordinate notation, e.g. "e2e4" or "e7e8q"
+    string toString() const {
+        if (!isValid()) {
+            return "0000";
+        }
+        string text = squareName(from) + squareName(to);
+        switch (promotion) {
+            case PieceType::KNIGHT: text += 'n'; break;
+            case PieceType::BISHOP: text += 'b'; break;
+            case PieceType::ROOK: text += 'r'; break;
+            case PieceType::QUEEN: text += 'q'; break;
+            default: break;
+        }
+        return text;
+    }
+
+    // Parses coordinate notation, returns an invalid Move if malformed
+    static Move fromString(const string& text) {
+        if (text.size() != 4 && text.size() != 5) {
+            return Move();
+        }
+        int from = parseSquare(text.substr(0, 2));
+        int to = parseSquare(text.substr(2, 2));
+        PieceType promotion = PieceType::EMPTY;
+        if (text.size() == 5) {
+            switch (text[4]) {
+                case 'n': promotion = PieceType::KNIGHT; break;
+                case 'b': promotion = PieceType::BISHOP; break;
+                case 'r': promotion = PieceType::ROOK; break;
+                case 'q': promotion = PieceType::QUEEN; break;
+                default: return Move();
+            }
+        }
+        if (from == NONE_SELECTED || to == NONE_SELECTED) {
+            return Move();
+        }
+        return Move(from, to, promotion);
+    }
+};
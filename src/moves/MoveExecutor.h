@@ -2,87 +2,186 @@
 
 #include "../board/Board.h"
 #include "MoveValidator.h"
-#include <set>
+#include "Move.h"
+#include <vector>
+#include <cassert>
+
+// Everything makeMove changes that cannot be recomputed from the move itself
+struct UndoRecord {
+    Move move;
+    ChessPiece captured;
+    int capturePos;
+    int castlingRights;
+    int enPassantMove;
+    int halfmoveClock;
+    uint8_t movedHistory;
+};
 
 class MoveExecutor {
 private:
     Board* state;
     MoveValidator* moveValidator;
-    sf::Sound* moveSound;
     bool doPromotion;
     int promotionPos;
     int curMoveNum;
+    vector<UndoRecord> undoStack;
+    size_t undoCount;
+
+    // Records are reused once created so making moves does not allocate
+    UndoRecord& pushUndo() {
+        if (undoCount == undoStack.size()) {
+            undoStack.emplace_back();
+        }
+        return undoStack.at(undoCount++);
+    }
+
+    bool isCastle(const ChessPiece& piece, const Move& move) const {
+        return piece.isOfType(PieceType::KING) && abs(move.from - move.to) == 2;
+    }
+
+    void moveCastleRook(const Move& move, bool undo) {
+        bool rookRight = move.to > move.from;
+        int rookFrom = (rookRight) ? move.from + 3 : move.from - 4;
+        int rookTo = move.to + ((rookRight) ? -1 : 1);
+        if (undo) {
+            state->movePiece(rookTo, rookFrom);
+        }
+        else {
+            state->movePiece(rookFrom, rookTo);
+        }
+    }
 
 public:
-    MoveExecutor(Board* state, MoveValidator* validator, sf::Sound& sound) 
-        : state(state), moveValidator(validator), moveSound(&sound) {
+    MoveExecutor(Board* state, MoveValidator* validator)
+        : state(state), moveValidator(validator) {
         doPromotion = false;
         promotionPos = NONE_SELECTED;
         curMoveNum = 0;
+        undoCount = 0;
+        undoStack.reserve(MAX_GAME_PLY);
     }
 
     void setCurrentMoveNumber(int moveNum) {
         curMoveNum = moveNum;
     }
 
-    GameState executeMove(int from, int to) {
-        ChessPiece oldPiece = state->getCell(to).getChessPiece();
-        ChessPiece& selectedPiece = state->getCell(from).getChessPiece();
-        
-        // Update piece state
-        selectedPiece.onMove(abs(from - to), curMoveNum);
-        
-        // Move the piece on the board
-        state->movePiece(from, to);
-        
-        // Check if this is a castling move
-        set<int> castleMoves = moveValidator->getCastleMoves();
-        if (castleMoves.find(to) != castleMoves.end()) {
-            bool rookRight = to > from;
-            int step = (rookRight) ? -1 : 1;
-            int rookPos = (rookRight) ? from + 3 : from - 4;
-            state->movePiece(rookPos, to + step);
+    // Plays a legal move on the board and pushes what is needed to take it back
+    void makeMove(const Move& move) {
+        int width = state->getWidth();
+        ChessPiece& piece = state->getPiece(move.from);
+        PieceSide side = piece.getSide();
+        bool isPawn = piece.isOfType(PieceType::PAWN);
+        bool isEnPassant = isPawn && move.to == state->getEnPassantMove();
+
+        UndoRecord& undo = pushUndo();
+        undo.move = move;
+        undo.capturePos = (isEnPassant) ? move.to + ((side == PieceSide::WHITE) ? -width : width) : move.to;
+        undo.castlingRights = state->getCastlingRights();
+        undo.enPassantMove = state->getEnPassantMove();
+        undo.halfmoveClock = state->getHalfmoveClock();
+        undo.movedHistory = piece.getHistory();
+
+        bool castle = isCastle(piece, move);
+        piece.onMove();
+        state->takePiece(undo.capturePos, undo.captured);
+        state->movePiece(move.from, move.to);
+        if (castle) {
+            moveCastleRook(move, false);
         }
-        // Check if this is an en passant move
-        else if (to == state->getEnPassantMove()) {
-            int width = state->getWidth();
-            PieceSide opposingSide = (state->getCell(to).getChessPiece().getSide() == PieceSide::WHITE) ? 
-                                     PieceSide::BLACK : PieceSide::WHITE;
-            int newIdx = to + width - 2 * width * (opposingSide == PieceSide::BLACK);
-            oldPiece = state->getCell(newIdx).getChessPiece();
-            state->movePiece(from, newIdx);
-            state->setEnPassantMove(NONE_SELECTED);
+        if (move.promotion != PieceType::EMPTY) {
+            state->setPiece(move.to, ChessPiece(move.promotion, side));
+        }
+
+        // A double pawn step leaves the skipped square open to en passant for one turn
+        state->setEnPassantMove((isPawn && abs(move.from - move.to) == 2 * width) ? (move.from + move.to) / 2 : NONE_SELECTED);
+        state->setCastlingRights(state->getCastlingRights() & ~(state->castlingRightsAt(move.from) | state->castlingRightsAt(move.to)));
+        state->setSideToMove(oppositeSide(side));
+        state->setHalfmoveClock((isPawn || undo.captured.isActive()) ? 0 : undo.halfmoveClock + 1);
+        if (side == PieceSide::BLACK) {
+            state->setFullmoveNumber(state->getFullmoveNumber() + 1);
+        }
+        state->updateAttacks();
+        assert(state->getHash() == state->computeHash());
+        assert(state->pieceSquareMatches());
+    }
+
+    // Takes back the last move made with makeMove
+    void unmakeMove() {
+        UndoRecord& undo = undoStack.at(--undoCount);
+        const Move& move = undo.move;
+        PieceSide side = oppositeSide(state->getSideToMove());
+
+        if (move.promotion != PieceType::EMPTY) {
+            state->setPiece(move.to, ChessPiece(PieceType::PAWN, side));
         }
-        
-        // Update score and captures for the turn
+        state->movePiece(move.to, move.from);
+        ChessPiece& piece = state->getPiece(move.from);
+        if (isCastle(piece, move)) {
+            moveCastleRook(move, true);
+        }
+        piece.setHistory(undo.movedHistory);
+        state->putPiece(undo.capturePos, undo.captured);
+
+        state->setEnPassantMove(undo.enPassantMove);
+        state->setCastlingRights(undo.castlingRights);
+        state->setSideToMove(side);
+        state->setHalfmoveClock(undo.halfmoveClock);
+        if (side == PieceSide::BLACK) {
+            state->setFullmoveNumber(state->getFullmoveNumber() - 1);
+        }
+        state->updateAttacks();
+        assert(state->getHash() == state->computeHash());
+        assert(state->pieceSquareMatches());
+    }
+
+    size_t getUndoCount() const { return undoCount; }
+
+    // Forgets the moves played, for when the board is set to a new position
+    void clearHistory() {
+        undoCount = 0;
+    }
+
+    // Plays a move from the GUI, keeping captures and reporting the resulting game state.
+    // A pawn reaching the last rank without a promotion piece waits for setPromotedPiece,
+    // which reports the state instead.
+    GameState executeMove(int from, int to, PieceType promotion = PieceType::EMPTY) {
+        makeMove(Move(from, to, promotion));
+
+        // Update captures for the turn
+        const ChessPiece& oldPiece = undoStack.at(undoCount - 1).captured;
         int turn = curMoveNum % 2;
         if (oldPiece.isActive()) {
-            state->addScore(turn, oldPiece.getValue());
             state->addCapture(turn, oldPiece);
         }
-        
-        // Check game state (check, checkmate, etc)
-        GameState turnState = moveValidator->check(state->getCell(to).getChessPiece().getSide(), true, oldPiece);
-        
+
         // Check if pawn promotion is needed
-        doPromotion = moveValidator->shouldPromote(selectedPiece, to);
+        ChessPiece& movedPiece = state->getPiece(to);
+        doPromotion = moveValidator->shouldPromote(movedPiece, to);
         promotionPos = (doPromotion) ? to : NONE_SELECTED;
-        
-        return turnState;
+        if (doPromotion) {
+            return GameState::NO_TURN;
+        }
+
+        // Check game state (check, checkmate, etc)
+        return moveValidator->check(movedPiece.getSide(), true);
     }
-    
-    void setPromotedPiece(Cell& cell) {
-        cell.getChessPiece().setSound(moveSound);
-        cell.movePiece(state->getCell(promotionPos));
+
+    // Replaces the pawn waiting on the last rank, the undo record is updated to match.
+    // Returns the game state with the new piece on the board.
+    GameState setPromotedPiece(const ChessPiece& piece) {
+        state->setPiece(promotionPos, piece);
+        state->updateAttacks();
+        undoStack.at(undoCount - 1).move.promotion = piece.getType();
         doPromotion = false;
         promotionPos = NONE_SELECTED;
+        return moveValidator->check(piece.getSide(), true);
     }
-    
+
     bool isDoPromotion() const { return doPromotion; }
-    
+
     PieceSide getPromotionSide() {
-        return state->getCell(promotionPos).getChessPiece().getSide();
+        return state->getPiece(promotionPos).getSide();
     }
-    
+
     int getPromotionPos() const { return promotionPos; }
 };
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Move.h"
+
+// No legal chess position has more than 218 moves
+const int MAX_MOVES = 256;
+
+// Fixed-capacity list of moves that lives on the stack, so generating moves
+// never touches the heap
+class MoveList {
+private:
+    Move moves[MAX_MOVES];
+    int count;
+
+public:
+    MoveList() : count(0) {}
+
+    void add(const Move& move) {
+        moves[count++] = move;
+    }
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](int i) { return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+
+    Move* begin() { return moves; }
+    Move* end() { return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+
+    bool contains(const Move& move) const {
+        for (int i = 0; i < count; i++) {
+            if (moves[i] == move) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whether any move lands on pos, regardless of where it starts or promotes to
+    bool containsTarget(int pos) const {
+        for (int i = 0; i < count; i++) {
+            if (moves[i].to == pos) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Perft.h"
+#include "PerftCache.h"
+#include "../util/WorkStealingPool.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+// Load carried by one pool thread during a parallel perft
+struct PerftThreadReport {
+    long long nodes = 0;
+    long long tasks = 0;
+    long long stolen = 0;
+    double busySeconds = 0;
+};
+
+// Splits the tree into one task per move sequence of splitDepth plies and
+// counts the subtrees on a work-stealing pool. Each task replays its moves
+// on a private board copy, totals are gathered per root move so the divide
+// output matches the sequential Perft.
+class ParallelPerft {
+private:
+    // Written only by the thread it belongs to, padded so threads do not share cache lines
+    struct alignas(64) ThreadCounters {
+        long long nodes = 0;
+        double busySeconds = 0;
+    };
+
+    WorkStealingPool* pool;
+    PerftCache* cache;
+
+    void collectPaths(Perft& perft, vector<Move>& path, int remaining, vector<vector<Move>>& paths) {
+        if (remaining == 0) {
+            paths.push_back(path);
+            return;
+        }
+        MoveList moves = perft.getLegalMoves();
+        if (moves.empty()) {
+            return;
+        }
+        for (const Move& move : moves) {
+            path.push_back(move);
+            perft.getExecutor().makeMove(move);
+            collectPaths(perft, path, remaining - 1, paths);
+            perft.getExecutor().unmakeMove();
+            path.pop_back();
+        }
+    }
+
+public:
+    ParallelPerft(WorkStealingPool& pool, PerftCache* cache = nullptr) : pool(&pool), cache(cache) {}
+
+    // Same result as Perft::divide, splitDepth is clamped to 1..depth-1
+    void divide(const Board& root, int depth, int splitDepth, vector<pair<Move, long long>>& counts, vector<PerftThreadReport>& reports) {
+        counts.clear();
+        reports.assign(pool->getThreadCount(), PerftThreadReport());
+        if (depth < 1) {
+            return;
+        }
+        splitDepth = max(1, min(splitDepth, depth - 1));
+
+        Board board = root;
+        Perft perft(&board);
+        MoveList rootMoves = perft.getLegalMoves();
+        unique_ptr<atomic<long long>[]> rootCounts(new atomic<long long>[rootMoves.size()]);
+        for (int i = 0; i < rootMoves.size(); i++) {
+            rootCounts[i] = 0;
+        }
+
+        // Leaves are one ply below the root, nothing to split
+        if (depth == 1) {
+            for (int i = 0; i < rootMoves.size(); i++) {
+                counts.push_back({ rootMoves[i], 1 });
+            }
+            return;
+        }
+
+        vector<ThreadCounters> counters(pool->getThreadCount());
+        pool->resetStats();
+        for (int i = 0; i < rootMoves.size(); i++) {
+            vector<vector<Move>> paths;
+            vector<Move> path = { rootMoves[i] };
+            perft.getExecutor().makeMove(rootMoves[i]);
+            collectPaths(perft, path, splitDepth - 1, paths);
+            perft.getExecutor().unmakeMove();
+
+            for (vector<Move>& taskPath : paths) {
+                pool->submit([&, i, taskPath, depth](int worker) {
+                    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                    Board taskBoard = root;
+                    Perft taskPerft(&taskBoard, cache);
+                    for (const Move& move : taskPath) {
+                        taskPerft.getExecutor().makeMove(move);
+                    }
+                    long long nodes = taskPerft.countNodes(depth - (int)taskPath.size());
+                    rootCounts[i] += nodes;
+                    counters[worker].nodes += nodes;
+                    counters[worker].busySeconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                });
+            }
+        }
+        pool->waitIdle();
+
+        for (int i = 0; i < rootMoves.size(); i++) {
+            counts.push_back({ rootMoves[i], rootCounts[i].load() });
+        }
+        for (int t = 0; t < pool->getThreadCount(); t++) {
+            reports[t].nodes = counters[t].nodes;
+            reports[t].busySeconds = counters[t].busySeconds;
+            reports[t].tasks = pool->getStats(t).executed;
+            reports[t].stolen = pool->getStats(t).stolen;
+        }
+    }
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "MoveValidator.h"
+#include "MoveExecutor.h"
+#include "Move.h"
+#include "MoveList.h"
+#include "PerftCache.h"
+#include <vector>
+
+// Walks the legal move tree below a position and counts the leaf nodes.
+// Moves are made and unmade in place on the given board.
+class Perft {
+private:
+    Board* state;
+    MoveValidator validator;
+    MoveExecutor executor;
+    PerftCache* cache; // optional, shared between threads
+
+public:
+    Perft(Board* state, PerftCache* cache = nullptr) : state(state), validator(state), executor(state, &validator), cache(cache) {}
+
+    // Every legal move for the side to move, with one entry per promotion piece
+    MoveList getLegalMoves() {
+        MoveList moves;
+        validator.getLegalMoves(moves);
+        return moves;
+    }
+
+    long long countNodes(int depth) {
+        if (depth == 0) {
+            return 1;
+        }
+        long long nodes = 0;
+        if (cache && depth > 1 && cache->probe(state->getHash(), depth, nodes)) {
+            return nodes;
+        }
+        MoveList moves;
+        validator.getLegalMoves(moves);
+        // Leaves are counted straight from the move list
+        if (depth == 1) {
+            return moves.size();
+        }
+        for (const Move& move : moves) {
+            executor.makeMove(move);
+            nodes += countNodes(depth - 1);
+            executor.unmakeMove();
+        }
+        if (cache) {
+            cache->store(state->getHash(), depth, nodes);
+        }
+        return nodes;
+    }
+
+    // Node counts below each root move, the list is filled in root move order
+    void divide(int depth, vector<pair<Move, long long>>& counts) {
+        counts.clear();
+        if (depth < 1) {
+            return;
+        }
+        MoveList moves;
+        validator.getLegalMoves(moves);
+        for (const Move& move : moves) {
+            executor.makeMove(move);
+            counts.push_back({ move, countNodes(depth - 1) });
+            executor.unmakeMove();
+        }
+    }
+
+    MoveExecutor& getExecutor() { return executor; }
+
+    // Published node counts from the standard start position, indexed by depth
+    static long long getStartPositionCount(int depth) {
+        const long long counts[] = { 1, 20, 400, 8902, 197281, 4865609, 119060324, 3195901860LL, 84998978956LL };
+        return (depth >= 0 && depth < 9) ? counts[depth] : -1;
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+// Leaf counts of positions already walked, keyed by Zobrist hash and depth.
+// Slots are shared by perft threads without locks: each stores the packed
+// count and depth plus the key XOR that word, so a torn slot reads as a miss.
+class PerftCache {
+private:
+    struct Slot {
+        atomic<uint64_t> check; // key ^ data
+        atomic<uint64_t> data;  // count << 8 | depth
+    };
+
+    unique_ptr<Slot[]> slots;
+    uint64_t mask;
+
+    // Different depths of one position go to different slots
+    Slot& slotFor(uint64_t key, int depth) const {
+        return slots[(key ^ (depth * 0x9E3779B97F4A7C15ULL)) & mask];
+    }
+
+public:
+    // Size is rounded down to a power of two number of slots
+    PerftCache(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024) {
+            count *= 2;
+        }
+        slots.reset(new Slot[count]);
+        mask = count - 1;
+        for (size_t i = 0; i < count; i++) {
+            slots[i].check.store(0, memory_order_relaxed);
+            slots[i].data.store(0, memory_order_relaxed);
+        }
+    }
+
+    bool probe(uint64_t key, int depth, long long& count) const {
+        Slot& slot = slotFor(key, depth);
+        uint64_t data = slot.data.load(memory_order_relaxed);
+        uint64_t check = slot.check.load(memory_order_relaxed);
+        if ((check ^ data) != key || (int)(data & 0xFF) != depth) {
+            return false;
+        }
+        count = (long long)(data >> 8);
+        return true;
+    }
+
+    void store(uint64_t key, int depth, long long count) {
+        Slot& slot = slotFor(key, depth);
+        uint64_t data = ((uint64_t)count << 8) | (uint64_t)depth;
+        slot.check.store(key ^ data, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+};
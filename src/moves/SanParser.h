@@ -0,0 +1,99 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "MoveList.h"
+
+using namespace std;
+
+// Resolves standard algebraic notation (e.g. "Nbd7", "exd8=Q+", "O-O")
+// against the legal moves of a position.
+class SanParser {
+private:
+    static PieceType pieceFromLetter(char letter) {
+        switch (letter) {
+            case 'N': return PieceType::KNIGHT;
+            case 'B': return PieceType::BISHOP;
+            case 'R': return PieceType::ROOK;
+            case 'Q': return PieceType::QUEEN;
+            case 'K': return PieceType::KING;
+            default: return PieceType::EMPTY;
+        }
+    }
+
+public:
+    // Number of legal moves the text matches: 0 if it is illegal or malformed,
+    // 1 if move was set, more if it is ambiguous
+    static int resolve(const Board& board, const MoveList& legalMoves, const char* san, int length, Move& move) {
+        // Check, mate and annotation marks carry no information for the move
+        while (length > 0 && (san[length - 1] == '+' || san[length - 1] == '#' || san[length - 1] == '!' || san[length - 1] == '?')) {
+            length--;
+        }
+        if (length < 2) {
+            return 0;
+        }
+
+        int width = board.getWidth();
+        PieceType type = PieceType::PAWN;
+        PieceType promotion = PieceType::EMPTY;
+        int fromFile = NONE_SELECTED, fromRank = NONE_SELECTED, to = NONE_SELECTED;
+        int castleStep = 0;
+
+        if (san[0] == 'O' || san[0] == '0') {
+            bool queenside = length == 5 && (san[3] == '-');
+            if (length != 3 && !queenside) {
+                return 0;
+            }
+            type = PieceType::KING;
+            castleStep = (queenside) ? -2 : 2;
+        }
+        else {
+            int end = length;
+            PieceType last = pieceFromLetter(san[end - 1]);
+            if (last != PieceType::EMPTY && last != PieceType::KING) {
+                promotion = last;
+                end -= (san[end - 2] == '=') ? 2 : 1;
+            }
+            if (end < 2) {
+                return 0;
+            }
+            int file = san[end - 2] - 'a', rank = san[end - 1] - '1';
+            if (file < 0 || file >= width || rank < 0 || rank >= board.getHeight()) {
+                return 0;
+            }
+            to = rank * width + file;
+
+            // What is left is the piece letter, the origin hints and the capture mark
+            int start = 0;
+            if (pieceFromLetter(san[0]) != PieceType::EMPTY) {
+                type = pieceFromLetter(san[0]);
+                start = 1;
+            }
+            for (int i = start; i < end - 2; i++) {
+                if (san[i] >= 'a' && san[i] < 'a' + width) {
+                    fromFile = san[i] - 'a';
+                }
+                else if (san[i] >= '1' && san[i] < '1' + board.getHeight()) {
+                    fromRank = san[i] - '1';
+                }
+                else if (san[i] != 'x' && san[i] != ':') {
+                    return 0;
+                }
+            }
+        }
+
+        int matches = 0;
+        for (const Move& candidate : legalMoves) {
+            const ChessPiece& piece = board.getPiece(candidate.from);
+            bool matched = piece.isOfType(type)
+                && ((castleStep) ? candidate.to - candidate.from == castleStep
+                    : candidate.to == to && candidate.promotion == promotion
+                        && (fromFile == NONE_SELECTED || candidate.from % width == fromFile)
+                        && (fromRank == NONE_SELECTED || candidate.from / width == fromRank));
+            if (matched) {
+                move = candidate;
+                matches++;
+            }
+        }
+        return matches;
+    }
+};
@@ -1,160 +1,110 @@
 #pragma once
 #include <vector>
 #include <string>
-#include <sstream>
-#include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
+#include <cstdint>
 
 #include "../constants/Constants.h"
 #include "../constants/Enums.h"
 using namespace std;
 
+// Value and letter shared by every piece of one type. Built once by
+// ChessPieceRegistry, how pieces move lives in the bitboard move generator.
+struct PieceDefinition {
+	PieceType pieceType = PieceType::EMPTY;
+	int value = 0; // in pawns
+	char glyph = ' '; // FEN letter, lower case
+
+	// Defined next to the registry in ChessPieceBuilder.cpp
+	static const PieceDefinition& forType(PieceType type);
+};
+
+// A piece on a square packed into one byte: type, side and movement flags.
+// Everything that is the same for all pieces of a type lives in PieceDefinition.
 class ChessPiece {
 private:
-	PieceType pieceType;
-	vector<bool> validDirections; // format: {canMoveHorizontal, canMoveVertical, canMoveDiagonal}
-	vector<int> takeMoves;
-	int range, value;
-	PieceSide side;
-	bool activePiece, strictMotion, strictCapture, specialTakeMoves;
-	vector<int> strictMoves; // int offsets from position instead of directions where needed (ie knight)
-	string name;
-	sf::Texture texture;
-	sf::Sound* moveSound;
-
-	// Pawn specific attributes
-	int moves, lastMoveDiff, doubleMoveTurn;
-
-	// King specific attributes
-	bool kingCanCastle;
-
-	void flipVector(vector<int>& v) {
-		for (int& i : v) {
-			i *= -1;
-		}
-	}
+	static const uint8_t TYPE_MASK = 0x07;
+	static const uint8_t BLACK_FLAG = 0x08;
+	static const uint8_t MOVED_FLAG = 0x10;
+	static const uint8_t CASTLE_FLAG = 0x20;
+	static const uint8_t HISTORY_MASK = MOVED_FLAG | CASTLE_FLAG;
 
-	friend class ChessPieceBuilder;
-	friend class ChessPieceRegistry;
+	uint8_t code;
+
+	const PieceDefinition& definition() const {
+		return PieceDefinition::forType(getType());
+	}
 
 public:
-	ChessPiece(PieceType type) {
-		pieceType = type;
-		side = PieceSide::WHITE;
-		activePiece = true;
-		strictMotion = false;
-		strictCapture = false;
-		specialTakeMoves = false;
-		moves = 0;
-		lastMoveDiff = 0;
-		doubleMoveTurn = -1;
-		kingCanCastle = false;
-		range = 0;
-		value = 0;
-		name = "";
+	ChessPiece(PieceType type, PieceSide side = PieceSide::WHITE) {
+		code = (uint8_t)type;
+		if (side == PieceSide::BLACK) {
+			code |= BLACK_FLAG;
+		}
+		if (type == PieceType::KING) {
+			code |= CASTLE_FLAG;
+		}
 	}
 
 	ChessPiece() : ChessPiece(PieceType::EMPTY) {}
 
-	void loadTexture() {
-		if (activePiece) {
-			ostringstream fileName;
-			fileName << TEXTURE_PATH << ((side == PieceSide::BLACK) ? "b" : "w") << "_" << name << ".png";
-			texture.loadFromFile(fileName.str());
-		}
+	void onMove() {
+		code = (code & ~CASTLE_FLAG) | MOVED_FLAG;
 	}
 
-	void setSound(sf::Sound* sound) {
-		moveSound = sound;
+	// Moved and castling flags for undo records
+	uint8_t getHistory() const {
+		return code & HISTORY_MASK;
 	}
 
-	void onMove(int moveDiff, int moveNum) {
-		moveSound->play();
-		kingCanCastle = false;
-		if (!moves++ && isOfType(PieceType::PAWN)) {
-			if (moveDiff == 2 * BOARD_WIDTH) {
-				doubleMoveTurn = moveNum;
-			}
-			strictMoves.erase(strictMoves.begin() + 1);
-		}
-		lastMoveDiff = moveDiff;
+	void setHistory(uint8_t history) {
+		code = (code & ~HISTORY_MASK) | (history & HISTORY_MASK);
 	}
 
 	void switchSide() {
-		side = (side == PieceSide::WHITE) ? PieceSide::BLACK : PieceSide::WHITE;
-		loadTexture();
-		if (isOfType(PieceType::PAWN)) {
-			flipVector(takeMoves);
-			flipVector(strictMoves);
-		}
+		code ^= BLACK_FLAG;
 	}
 
 	PieceSide getSide() const {
-		return side;
-	}
-
-	void onCapture() {
-		return;
-	}
-
-	int getRange() const {
-		return range;
-	}
-
-	vector<bool> getValidDirections() const {
-		return validDirections;
+		return (code & BLACK_FLAG) ? PieceSide::BLACK : PieceSide::WHITE;
 	}
 
 	bool isActive() const {
-		return activePiece;
+		return getType() != PieceType::EMPTY;
 	}
 
 	bool isOnSide(PieceSide s) const {
-		return activePiece && side == s;
-	}
-
-	vector<int> getStrictMoves() const {
-		return strictMoves;
-	}
-
-	bool useStrictMotion() const {
-		return strictMotion;
-	}
-
-	bool canTakeStrictly() const {
-		return strictCapture;
+		return isActive() && getSide() == s;
 	}
 
-	bool hasSpecialTakeMoves() const {
-		return specialTakeMoves;
+	int getValue() const {
+		return definition().value;
 	}
 
-	vector<int> getTakeMoves() const {
-		return takeMoves;
+	char getGlyph() const {
+		return definition().glyph;
 	}
 
-	sf::Texture getTexture() const {
-		return texture;
+	bool isOfType(PieceType type) const {
+		return getType() == type;
 	}
 
-	int getValue() const {
-		return value;
+	PieceType getType() const {
+		return (PieceType)(code & TYPE_MASK);
 	}
 
-	string getName() const {
-		return name;
+	bool hasMoved() const {
+		return code & MOVED_FLAG;
 	}
 
-	bool isOfType(PieceType type) const {
-		return pieceType == type;
+	bool canCastle() const {
+		return code & CASTLE_FLAG;
 	}
 
-	bool canBeEnPassanted(int moveNum) const {
-		// First move, moved two spaces, turn after move
-		return isOfType(PieceType::PAWN) && moves == 1 && lastMoveDiff == 2 * BOARD_WIDTH && moveNum == doubleMoveTurn + 1;
+	bool operator==(const ChessPiece& other) const {
+		return code == other.code;
 	}
 
-	bool canCastle() const {
-		return kingCanCastle;
+	bool operator!=(const ChessPiece& other) const {
+		return code != other.code;
 	}
-};
\ No newline at end of file
+};
@@ -0,0 +1,5 @@
+#include "ChessPieceBuilder.h"
+
+const PieceDefinition& PieceDefinition::forType(PieceType type) {
+    return ChessPieceRegistry::getDefinition(type);
+}
@@ -1,188 +1,100 @@
 #pragma once
 #include "ChessPiece.h"
-#include <unordered_map>
-#include <memory>
+#include <array>
 
-class ChessPieceRegistry;
-
-// Fluent interface builder for ChessPiece
+// Fluent interface builder for PieceDefinition
 class ChessPieceBuilder {
 private:
-    ChessPiece piece;
+    PieceDefinition piece;
 
 public:
-    ChessPieceBuilder() : piece(PieceType::EMPTY) {}
-    explicit ChessPieceBuilder(PieceType type) : piece(type) {}
+    ChessPieceBuilder() {}
 
     ChessPieceBuilder& type(PieceType type) {
         piece.pieceType = type;
         return *this;
     }
 
-    ChessPieceBuilder& range(int range) {
-        piece.range = range;
-        return *this;
-    }
-
     ChessPieceBuilder& value(int value) {
         piece.value = value;
         return *this;
     }
 
-    ChessPieceBuilder& name(const std::string& name) {
-        piece.name = name;
-        return *this;
-    }
-
-    ChessPieceBuilder& side(PieceSide side) {
-        piece.side = side;
-        if (side == PieceSide::BLACK) {
-            piece.switchSide();
-        }
-        return *this;
-    }
-
-    ChessPieceBuilder& directions(bool horizontal, bool vertical, bool diagonal) {
-        piece.validDirections = { horizontal, vertical, diagonal };
-        return *this;
-    }
-
-    ChessPieceBuilder& strictMotion(bool strict) {
-        piece.strictMotion = strict;
-        return *this;
-    }
-
-    ChessPieceBuilder& strictCapture(bool strict) {
-        piece.strictCapture = strict;
-        return *this;
-    }
-
-    ChessPieceBuilder& specialTakeMoves(bool special) {
-        piece.specialTakeMoves = special;
-        return *this;
-    }
-
-    ChessPieceBuilder& strictMoves(const std::vector<int>& moves) {
-        piece.strictMoves = moves;
-        return *this;
-    }
-
-    ChessPieceBuilder& takeMoves(const std::vector<int>& moves) {
-        piece.takeMoves = moves;
-        return *this;
-    }
-
-    ChessPieceBuilder& canCastle(bool canCastle) {
-        piece.kingCanCastle = canCastle;
+    ChessPieceBuilder& glyph(char glyph) {
+        piece.glyph = glyph;
         return *this;
     }
 
-    ChessPieceBuilder& active(bool active) {
-        piece.activePiece = active;
-        return *this;
-    }
-
-    ChessPiece build() {
-        piece.loadTexture();
+    PieceDefinition build() {
         return piece;
     }
 };
 
-// A registry to hold predefined piece configurations
+// A registry to hold the definition of each piece type
 class ChessPieceRegistry {
 private:
-    static std::unordered_map<PieceType, ChessPiece> pieceTemplates;
+    static array<PieceDefinition, 7> build() {
+        array<PieceDefinition, 7> definitions; // indexed by PieceType
 
-public:
-    static void initialize() {
-        if (!pieceTemplates.empty()) return;
-
-        pieceTemplates[PieceType::PAWN] = ChessPieceBuilder()
+        definitions[(int)PieceType::PAWN] = ChessPieceBuilder()
             .type(PieceType::PAWN)
-            .range(1)
             .value(1)
-            .name("pawn")
-            .directions(false, false, false)
-            .strictMotion(true)
-            .specialTakeMoves(true)
-            .takeMoves({ BOARD_WIDTH - 1, BOARD_WIDTH + 1 })
-            .strictMoves({ BOARD_WIDTH, 2 * BOARD_WIDTH })
+            .glyph('p')
             .build();
 
-        pieceTemplates[PieceType::KNIGHT] = ChessPieceBuilder()
+        definitions[(int)PieceType::KNIGHT] = ChessPieceBuilder()
             .type(PieceType::KNIGHT)
-            .range(MAX_RANGE)
             .value(3)
-            .name("knight")
-            .directions(false, false, false)
-            .strictMotion(true)
-            .strictCapture(true)
-            .strictMoves({ -2 * BOARD_WIDTH - 1, -2 * BOARD_WIDTH + 1, -BOARD_WIDTH - 2,
-                         -BOARD_WIDTH + 2, BOARD_WIDTH - 2, BOARD_WIDTH + 2,
-                         2 * BOARD_WIDTH - 1, 2 * BOARD_WIDTH + 1 })
+            .glyph('n')
             .build();
 
-        pieceTemplates[PieceType::BISHOP] = ChessPieceBuilder()
+        definitions[(int)PieceType::BISHOP] = ChessPieceBuilder()
             .type(PieceType::BISHOP)
-            .range(MAX_RANGE)
             .value(3)
-            .name("bishop")
-            .directions(false, false, true)
+            .glyph('b')
             .build();
 
-        pieceTemplates[PieceType::ROOK] = ChessPieceBuilder()
+        definitions[(int)PieceType::ROOK] = ChessPieceBuilder()
             .type(PieceType::ROOK)
-            .range(MAX_RANGE)
             .value(5)
-            .name("rook")
-            .directions(true, true, false)
+            .glyph('r')
             .build();
 
-        pieceTemplates[PieceType::QUEEN] = ChessPieceBuilder()
+        definitions[(int)PieceType::QUEEN] = ChessPieceBuilder()
             .type(PieceType::QUEEN)
-            .range(MAX_RANGE)
             .value(9)
-            .name("queen")
-            .directions(true, true, true)
+            .glyph('q')
             .build();
 
-        pieceTemplates[PieceType::KING] = ChessPieceBuilder()
+        definitions[(int)PieceType::KING] = ChessPieceBuilder()
             .type(PieceType::KING)
-            .range(1)
             .value(0)
-            .name("king")
-            .directions(true, true, true)
-            .canCastle(true)
+            .glyph('k')
             .build();
 
-        pieceTemplates[PieceType::EMPTY] = ChessPieceBuilder()
+        definitions[(int)PieceType::EMPTY] = ChessPieceBuilder()
             .type(PieceType::EMPTY)
             .value(0)
-            .name("empty")
-            .active(false)
+            .glyph(' ')
             .build();
-    }
 
-    static const ChessPiece& getPieceTemplate(PieceType type) {
-        if (pieceTemplates.empty()) {
-            initialize();
-        }
-        return pieceTemplates[type];
+        return definitions;
     }
 
-    static ChessPiece fromTemplate(PieceType type) {
-        return ChessPiece(ChessPieceRegistry::getPieceTemplate(type));
+public:
+    // The local static is built once even when threads ask at the same time
+    static const PieceDefinition& getDefinition(PieceType type) {
+        static const array<PieceDefinition, 7> definitions = build();
+        return definitions[(int)type];
     }
 };
 
-std::unordered_map<PieceType, ChessPiece> ChessPieceRegistry::pieceTemplates;
-
 
 // Factory to create instances of predefined pieces
 class ChessPieceFactory {
 public:
-    static ChessPiece createPiece(PieceType type) {
-        return ChessPieceRegistry::fromTemplate(type);
+    static ChessPiece createPiece(PieceType type, PieceSide side = PieceSide::WHITE) {
+        return ChessPiece(type, side);
     }
 
     static std::vector<ChessPiece> createStandardBackRow() {
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../board/Board.h"
+
+// Centipawn score of a position from the point of view of the side to move
+class Evaluation {
+public:
+    static constexpr int PAWN_VALUE = 100;
+    static constexpr int PIECE_VALUES[7] = { 0, PAWN_VALUE, 3 * PAWN_VALUE, 3 * PAWN_VALUE, 5 * PAWN_VALUE, 9 * PAWN_VALUE, 0 }; // by PieceType
+
+    // Used to order captures, so it is a plain table lookup
+    static constexpr int pieceValue(PieceType type) {
+        return PIECE_VALUES[(int)type];
+    }
+
+    // Blend of the middlegame and endgame sums by how much material is left
+    static int taper(int middlegame, int endgame, int phase, PieceSide side) {
+        phase = min(phase, PieceSquare::MAX_PHASE); // more than the starting material after promotions
+        int score = (middlegame * phase + endgame * (PieceSquare::MAX_PHASE - phase)) / PieceSquare::MAX_PHASE;
+        return (side == PieceSide::WHITE) ? score : -score;
+    }
+
+    // Material and piece placement from the sums the board keeps as pieces move
+    static int evaluate(const Board& state) {
+        return taper(state.getMiddlegameScore(), state.getEndgameScore(), state.getPhase(), state.getSideToMove());
+    }
+
+    // The same score summed over every piece, for checking and comparing against evaluate
+    static int evaluateFromScratch(const Board& state) {
+        int middlegame, endgame, phase;
+        state.computePieceSquare(middlegame, endgame, phase);
+        return taper(middlegame, endgame, phase, state.getSideToMove());
+    }
+};
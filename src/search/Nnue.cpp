@@ -0,0 +1,202 @@
+#include "Nnue.h"
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define CHESS_HAS_SIMD
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+// out = in + the added rows - the removed rows. Lanes wrap around like the
+// vector instructions, so every kernel gives the same result.
+static void updateScalar(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount,
+    const int16_t* const removed[], int removedCount) {
+    uint16_t lanes[NNUE_HIDDEN_SIZE];
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i++) {
+        lanes[i] = in[i];
+    }
+    for (int a = 0; a < addedCount; a++) {
+        for (int i = 0; i < NNUE_HIDDEN_SIZE; i++) {
+            lanes[i] += added[a][i];
+        }
+    }
+    for (int r = 0; r < removedCount; r++) {
+        for (int i = 0; i < NNUE_HIDDEN_SIZE; i++) {
+            lanes[i] -= removed[r][i];
+        }
+    }
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i++) {
+        out[i] = (int16_t)lanes[i];
+    }
+}
+
+// Sum of each hidden value clipped to 0..ACTIVATION_SCALE times its weight
+static int32_t outputScalar(const int16_t* hidden, const int8_t* weights) {
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i++) {
+        int clipped = min(max((int)hidden[i], 0), Nnue::ACTIVATION_SCALE);
+        sum += clipped * weights[i];
+    }
+    return sum;
+}
+
+#ifdef CHESS_HAS_SIMD
+TARGET_SSE41
+static void updateSse41(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount,
+    const int16_t* const removed[], int removedCount) {
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 8) {
+        __m128i lanes = _mm_load_si128((const __m128i*)(in + i));
+        for (int a = 0; a < addedCount; a++) {
+            lanes = _mm_add_epi16(lanes, _mm_load_si128((const __m128i*)(added[a] + i)));
+        }
+        for (int r = 0; r < removedCount; r++) {
+            lanes = _mm_sub_epi16(lanes, _mm_load_si128((const __m128i*)(removed[r] + i)));
+        }
+        _mm_store_si128((__m128i*)(out + i), lanes);
+    }
+}
+
+// Packing to unsigned bytes clips at 0, so one byte minimum finishes the
+// clipping. Byte pairs multiplied by maddubs stay below the int16 limit.
+TARGET_SSE41
+static int32_t outputSse41(const int16_t* hidden, const int8_t* weights) {
+    const __m128i limit = _mm_set1_epi8(Nnue::ACTIVATION_SCALE);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 16) {
+        __m128i packed = _mm_packus_epi16(_mm_load_si128((const __m128i*)(hidden + i)), _mm_load_si128((const __m128i*)(hidden + i + 8)));
+        __m128i products = _mm_maddubs_epi16(_mm_min_epu8(packed, limit), _mm_load_si128((const __m128i*)(weights + i)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+    }
+    sum = _mm_hadd_epi32(sum, sum);
+    sum = _mm_hadd_epi32(sum, sum);
+    return _mm_cvtsi128_si32(sum);
+}
+
+TARGET_AVX2
+static void updateAvx2(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount,
+    const int16_t* const removed[], int removedCount) {
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 16) {
+        __m256i lanes = _mm256_load_si256((const __m256i*)(in + i));
+        for (int a = 0; a < addedCount; a++) {
+            lanes = _mm256_add_epi16(lanes, _mm256_load_si256((const __m256i*)(added[a] + i)));
+        }
+        for (int r = 0; r < removedCount; r++) {
+            lanes = _mm256_sub_epi16(lanes, _mm256_load_si256((const __m256i*)(removed[r] + i)));
+        }
+        _mm256_store_si256((__m256i*)(out + i), lanes);
+    }
+}
+
+// Packing works within each 128 bit half, the permute restores the order
+TARGET_AVX2
+static int32_t outputAvx2(const int16_t* hidden, const int8_t* weights) {
+    const __m256i limit = _mm256_set1_epi8(Nnue::ACTIVATION_SCALE);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN_SIZE; i += 32) {
+        __m256i packed = _mm256_packus_epi16(_mm256_load_si256((const __m256i*)(hidden + i)), _mm256_load_si256((const __m256i*)(hidden + i + 16)));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        __m256i products = _mm256_maddubs_epi16(_mm256_min_epu8(packed, limit), _mm256_load_si256((const __m256i*)(weights + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_hadd_epi32(half, half);
+    half = _mm_hadd_epi32(half, half);
+    return _mm_cvtsi128_si32(half);
+}
+#endif
+
+unique_ptr<Nnue::Network> Nnue::network;
+Nnue::UpdateKernel Nnue::updateKernel = updateScalar;
+Nnue::OutputKernel Nnue::outputKernel = outputScalar;
+SimdMode Nnue::simdMode = Nnue::setSimdMode(Nnue::bestSimdMode());
+
+SimdMode Nnue::bestSimdMode() {
+#if defined(CHESS_HAS_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    if ((info[1] >> 5) & 1) {
+        return SimdMode::AVX2;
+    }
+    __cpuid(info, 1);
+    return ((info[2] >> 19) & 1) ? SimdMode::SSE41 : SimdMode::SCALAR;
+#elif defined(CHESS_HAS_SIMD)
+    __builtin_cpu_init(); // may run before the constructors that set up __builtin_cpu_supports
+    return (__builtin_cpu_supports("avx2")) ? SimdMode::AVX2 : (__builtin_cpu_supports("sse4.1")) ? SimdMode::SSE41 : SimdMode::SCALAR;
+#else
+    return SimdMode::SCALAR;
+#endif
+}
+
+SimdMode Nnue::setSimdMode(SimdMode mode) {
+    simdMode = min(mode, bestSimdMode());
+    updateKernel = updateScalar;
+    outputKernel = outputScalar;
+#ifdef CHESS_HAS_SIMD
+    if (simdMode == SimdMode::SSE41) {
+        updateKernel = updateSse41;
+        outputKernel = outputSse41;
+    }
+    else if (simdMode == SimdMode::AVX2) {
+        updateKernel = updateAvx2;
+        outputKernel = outputAvx2;
+    }
+#endif
+    return simdMode;
+}
+
+// Decodes little-endian int16 values byte by byte, so the host's byte order does not matter
+static const unsigned char* readInt16(const unsigned char* bytes, int16_t* values, size_t count) {
+    for (size_t i = 0; i < count; i++, bytes += 2) {
+        values[i] = (int16_t)(uint16_t)(bytes[0] | (bytes[1] << 8));
+    }
+    return bytes;
+}
+
+bool Nnue::load(const string& path) {
+    const size_t featureCount = INPUT_COUNT * NNUE_HIDDEN_SIZE + NNUE_HIDDEN_SIZE;
+    const size_t outputCount = 2 * NNUE_HIDDEN_SIZE;
+    ifstream file(path, ios::binary);
+    vector<unsigned char> bytes(HEADER_SIZE + 2 * featureCount + outputCount + 2);
+    if (!file.read((char*)bytes.data(), bytes.size()) || file.peek() != EOF || memcmp(bytes.data(), MAGIC, HEADER_SIZE) != 0) {
+        return false;
+    }
+    unique_ptr<Network> loaded(new Network());
+    const unsigned char* next = readInt16(bytes.data() + HEADER_SIZE, loaded->featureWeights[0], INPUT_COUNT * NNUE_HIDDEN_SIZE);
+    next = readInt16(next, loaded->featureBiases, NNUE_HIDDEN_SIZE);
+    memcpy(loaded->outputWeights, next, outputCount);
+    readInt16(next + outputCount, &loaded->outputBias, 1);
+    network = move(loaded);
+    return true;
+}
+
+void Nnue::randomize(uint64_t seed) {
+    mt19937_64 rng(seed);
+    auto uniform = [&](int low, int high) { return (int16_t)(low + (int)(rng() % (high - low + 1))); };
+    unique_ptr<Network> random(new Network());
+    for (auto& row : random->featureWeights) {
+        for (int16_t& weight : row) {
+            weight = uniform(-32, 32);
+        }
+    }
+    for (int16_t& bias : random->featureBiases) {
+        bias = uniform(0, 128);
+    }
+    for (auto& row : random->outputWeights) {
+        for (int8_t& weight : row) {
+            weight = (int8_t)uniform(-64, 64);
+        }
+    }
+    random->outputBias = 0;
+    network = move(random);
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "../moves/Move.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+const int NNUE_HIDDEN_SIZE = 256;
+
+// First layer outputs for a position, one half seen from each side
+struct NnueAccumulator {
+    alignas(32) int16_t values[2][NNUE_HIDDEN_SIZE]; // [sideIndex of the viewing side]
+};
+
+// Efficiently updatable neural network evaluation. Each side sees the board
+// as 768 inputs, one per piece type, colour relative to the viewer and
+// square, ranks mirrored for black. The inputs feed NNUE_HIDDEN_SIZE
+// neurons per side, kept in an NnueAccumulator that a move changes by
+// adding and subtracting a few weight rows. The clipped hidden layers of
+// the side to move and the other side are then reduced to one score.
+//
+// The first layer has int16 weights quantized by ACTIVATION_SCALE. Its
+// clipped outputs fit in a byte, so the output layer multiplies them with
+// int8 weights quantized by OUTPUT_WEIGHT_SCALE, and the output bias is
+// quantized by both. The kernels for a row update and the output sum are
+// picked for the CPU at startup.
+//
+// A network file is MAGIC followed by the little-endian int16 feature
+// weights [768][hidden] and feature biases [hidden], the int8 output
+// weights [2][hidden], the side to move first, and the int16 output bias.
+class Nnue {
+public:
+    static constexpr int INPUT_COUNT = 768;
+    static constexpr int ACTIVATION_SCALE = 127; // a hidden neuron clips to 0..ACTIVATION_SCALE
+    static constexpr int OUTPUT_WEIGHT_SCALE = 64;
+    static constexpr int EVAL_SCALE = 400; // centipawns per unit of network output
+    static constexpr int MAX_EVAL = 20000; // below tablebase and mate scores
+    static constexpr int HEADER_SIZE = 8;
+    static constexpr char MAGIC[HEADER_SIZE + 1] = "CHESSNN2";
+
+    // At most two inputs are turned on and two off by one move
+    static constexpr int MAX_CHANGES = 2;
+
+    struct Network {
+        alignas(32) int16_t featureWeights[INPUT_COUNT][NNUE_HIDDEN_SIZE];
+        alignas(32) int16_t featureBiases[NNUE_HIDDEN_SIZE];
+        alignas(32) int8_t outputWeights[2][NNUE_HIDDEN_SIZE];
+        int16_t outputBias;
+    };
+
+private:
+    typedef void (*UpdateKernel)(const int16_t* in, int16_t* out, const int16_t* const added[], int addedCount,
+        const int16_t* const removed[], int removedCount);
+    typedef int32_t (*OutputKernel)(const int16_t* hidden, const int8_t* weights);
+
+    static unique_ptr<Network> network;
+    static SimdMode simdMode;
+    static UpdateKernel updateKernel;
+    static OutputKernel outputKernel;
+
+    // Row of the feature weights for a piece seen from one side
+    static const int16_t* weightRow(int viewer, PieceType type, PieceSide side, int pos) {
+        int relative = (sideIndex(side) != viewer) * 6 + (int)type - 1;
+        return network->featureWeights[relative * 64 + ((viewer) ? pos ^ 56 : pos)];
+    }
+
+public:
+    // Replaces the network with the one in a file, keeping the old one if the file is bad.
+    // Only call while no search runs.
+    static bool load(const string& path);
+
+    // Small random weights, only useful for measuring speed
+    static void randomize(uint64_t seed);
+
+    static void unload() { network.reset(); }
+    static bool isLoaded() { return (bool)network; }
+
+    // SSE4.1 and AVX2 fall back to the best the CPU has, returns the mode now in use
+    static SimdMode setSimdMode(SimdMode mode);
+    static SimdMode getSimdMode() { return simdMode; }
+    static SimdMode bestSimdMode();
+
+    // Both halves of the accumulator computed from every piece on the board
+    static void refresh(const Board& board, NnueAccumulator& accumulator) {
+        const Bitboard occupied = board.getBitboards().getOccupied();
+        for (int viewer = 0; viewer < 2; viewer++) {
+            const int16_t* rows[64];
+            int count = 0;
+            Bitboard pieces = occupied;
+            while (pieces) {
+                int pos = popLsb(pieces);
+                rows[count++] = weightRow(viewer, board.getPiece(pos).getType(), board.getPiece(pos).getSide(), pos);
+            }
+            updateKernel(network->featureBiases, accumulator.values[viewer], rows, count, nullptr, 0);
+        }
+    }
+
+    // The accumulator after a legal move, from the one before it. The board
+    // must still be in the position before the move.
+    static void update(const Board& board, const Move& move, const NnueAccumulator& before, NnueAccumulator& after) {
+        const ChessPiece& piece = board.getPiece(move.from);
+        PieceType type = piece.getType();
+        PieceSide side = piece.getSide();
+        int width = board.getWidth();
+        int capturePos = (type == PieceType::PAWN && move.to == board.getEnPassantMove()) ? move.to + ((side == PieceSide::WHITE) ? -width : width) : move.to;
+        const ChessPiece& captured = board.getPiece(capturePos);
+        bool castle = type == PieceType::KING && abs(move.from - move.to) == 2;
+        int rookFrom = (move.to > move.from) ? move.from + 3 : move.from - 4;
+        int rookTo = move.to + ((move.to > move.from) ? -1 : 1);
+
+        for (int viewer = 0; viewer < 2; viewer++) {
+            const int16_t* added[MAX_CHANGES];
+            const int16_t* removed[MAX_CHANGES];
+            int addedCount = 0, removedCount = 0;
+            removed[removedCount++] = weightRow(viewer, type, side, move.from);
+            added[addedCount++] = weightRow(viewer, (move.promotion == PieceType::EMPTY) ? type : move.promotion, side, move.to);
+            if (captured.isActive()) {
+                removed[removedCount++] = weightRow(viewer, captured.getType(), captured.getSide(), capturePos);
+            }
+            else if (castle) {
+                removed[removedCount++] = weightRow(viewer, PieceType::ROOK, side, rookFrom);
+                added[addedCount++] = weightRow(viewer, PieceType::ROOK, side, rookTo);
+            }
+            updateKernel(before.values[viewer], after.values[viewer], added, addedCount, removed, removedCount);
+        }
+    }
+
+    // Centipawn score for the side to move
+    static int evaluate(const NnueAccumulator& accumulator, PieceSide sideToMove) {
+        int us = sideIndex(sideToMove);
+        int64_t sum = (int64_t)outputKernel(accumulator.values[us], network->outputWeights[0])
+            + outputKernel(accumulator.values[us ^ 1], network->outputWeights[1]);
+        int64_t score = (sum + network->outputBias) * EVAL_SCALE / (ACTIVATION_SCALE * OUTPUT_WEIGHT_SCALE);
+        return (int)max<int64_t>(min<int64_t>(score, MAX_EVAL), -MAX_EVAL);
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Search.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Lazy SMP: every thread searches the same root on its own board copy and
+// they share only the transposition table. Helpers start on alternating
+// depths so they fill the table ahead of the main thread. Every thread
+// stops at the node limit, counted over all of them. The main thread alone
+// applies the time limit and stops the helpers when it is done.
+class ParallelSearch {
+private:
+    TranspositionTable* table;
+    int threadCount;
+
+public:
+    ParallelSearch(TranspositionTable& table, int threadCount) : table(&table), threadCount(max(threadCount, 1)) {}
+
+    // onIteration is called from the main thread only. Setting stopRequest from
+    // another thread ends the search early with the last completed depth.
+    // gameHistory holds the hashes of the game positions before this one, see Search::setGameHistory.
+    SearchResult run(const Board& position, const SearchLimits& limits, function<void(const SearchResult&)> onIteration = nullptr,
+        const atomic<bool>* stopRequest = nullptr, const vector<uint64_t>& gameHistory = vector<uint64_t>()) {
+        table->newSearch();
+        atomic<bool> stopSignal(false);
+        atomic<long long> sharedNodes(0);
+        vector<unique_ptr<Search>> searches;
+        for (int i = 0; i < threadCount; i++) {
+            searches.emplace_back(new Search(position, *table, (i == 0) ? stopRequest : &stopSignal, &sharedNodes));
+            searches.back()->setGameHistory(gameHistory);
+        }
+
+        // Each thread writes only its own last finished iteration, read after the join
+        vector<SearchResult> results(threadCount);
+        auto publish = [&](int thread, const SearchResult& result) {
+            results[thread] = result;
+        };
+
+        SearchLimits helperLimits;
+        helperLimits.maxDepth = limits.maxDepth;
+        helperLimits.maxNodes = limits.maxNodes;
+        vector<thread> helpers;
+        for (int i = 1; i < threadCount; i++) {
+            helpers.emplace_back([&, i]() {
+                searches[i]->run(helperLimits, [&, i](const SearchResult& result) { publish(i, result); }, 1 + i % 2);
+            });
+        }
+
+        SearchResult mainResult = searches[0]->run(limits, [&](const SearchResult& result) {
+            publish(0, result);
+            if (onIteration) {
+                onIteration(result);
+            }
+        });
+        stopSignal = true;
+        for (thread& helper : helpers) {
+            helper.join();
+        }
+
+        // A helper's finished iteration replaces the main thread's only when it
+        // reached a greater depth with a better score
+        int best = 0;
+        for (int i = 1; i < threadCount; i++) {
+            if (results[i].depth > results[best].depth && results[i].score > results[best].score) {
+                best = i;
+            }
+        }
+        SearchResult result = (results[best].depth) ? results[best] : mainResult;
+        result.nodes = 0;
+        result.tableStats = TTStats();
+        for (const unique_ptr<Search>& search : searches) {
+            result.nodes += search->getNodes();
+            result.tableStats += search->getTableStats();
+        }
+        result.seconds = mainResult.seconds;
+        return result;
+    }
+
+    int getThreadCount() const { return threadCount; }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "../moves/Move.h"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Opening moves from a Polyglot .bin book. The file is mapped into memory
+// where the platform has mmap and read whole elsewhere. Its entries, sorted
+// by position key, are found by binary search, so opening costs nothing
+// beyond the mapping and a probe reads a few pages.
+//
+// Keys are built from the 781 Random64 constants of the Polyglot
+// specification, so any Polyglot book can be read.
+class PolyglotBook {
+public:
+    static constexpr int KEY_COUNT = 781;
+    static constexpr uint64_t START_POSITION_KEY = 0x463B96181691FC9CULL; // published with the specification
+
+private:
+    static constexpr int ENTRY_SIZE = 16; // key, move, weight and learn, all big-endian
+    static constexpr int CASTLING_OFFSET = 768;
+    static constexpr int EN_PASSANT_OFFSET = 772;
+    static constexpr int TURN_OFFSET = 780;
+
+    static const uint64_t RANDOM64[KEY_COUNT];
+
+    const unsigned char* data;
+    size_t entryCount;
+    size_t mappedBytes; // 0 when the file was read into buffer
+    vector<unsigned char> buffer;
+    mt19937_64 rng;
+
+    uint64_t keyAt(size_t index) const;
+    static Move decodeMove(int code, const Board& board);
+
+public:
+    PolyglotBook() : data(nullptr), entryCount(0), mappedBytes(0), rng(random_device()()) {}
+
+    ~PolyglotBook() {
+        close();
+    }
+
+    PolyglotBook(const PolyglotBook&) = delete;
+    PolyglotBook& operator=(const PolyglotBook&) = delete;
+
+    // Opens a .bin file, replacing any book already open
+    bool open(const string& path);
+    void close();
+
+    bool isReady() const { return data; }
+    size_t getEntryCount() const { return entryCount; }
+
+    // Polyglot hash of a position. En passant only counts when a pawn of the
+    // side to move stands ready to take it.
+    static uint64_t computeKey(const Board& board);
+
+    // Finds a legal book move for the position, false if the book has none
+    bool probe(const Board& board, Move& move, BookSelection selection = BookSelection::WEIGHTED);
+};
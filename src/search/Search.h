@@ -0,0 +1,416 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "../moves/MoveValidator.h"
+#include "../moves/MoveExecutor.h"
+#include "../moves/MoveList.h"
+#include "TranspositionTable.h"
+#include "Evaluation.h"
+#include "Nnue.h"
+#include "Tablebase.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+const int MAX_SEARCH_PLY = 64;
+const int INFINITE_SCORE = 32000;
+const int MATE_SCORE = 31000; // mate in n plies scores MATE_SCORE - n
+const int TABLEBASE_WIN_SCORE = MATE_SCORE - 2 * MAX_SEARCH_PLY; // below every mate score
+const int NODE_BATCH = 1024; // nodes a thread counts before adding them to the shared total
+
+// When to stop searching, a zero limit is not applied
+struct SearchLimits {
+    int maxDepth = MAX_SEARCH_PLY - 1;
+    long long maxNodes = 0;
+    double maxSeconds = 0;
+};
+
+// The last completed iteration
+struct SearchResult {
+    Move bestMove;
+    int score = 0;
+    int depth = 0;
+    long long nodes = 0;
+    double seconds = 0;
+    vector<Move> pv;
+    TTStats tableStats; // this search's transposition table probes
+};
+
+// Negamax alpha-beta with iterative deepening on a private copy of the board.
+// Results are shared with other searches through the transposition table.
+class Search {
+private:
+    Board board;
+    MoveValidator validator;
+    MoveExecutor executor;
+    TranspositionTable* table;
+    TTStats tableStats;
+
+    SearchLimits limits;
+    chrono::steady_clock::time_point startTime;
+    atomic<long long> nodes; // written only by the searching thread, read by others
+    atomic<long long>* sharedNodes; // nodes of every thread searching this root, added in batches
+    long long sharedTotal; // sharedNodes after this thread's last batch
+    bool stopped;
+    const atomic<bool>* stopSignal; // set by another thread to end the search early
+
+    Move pvTable[MAX_SEARCH_PLY][MAX_SEARCH_PLY]; // best line found below each ply
+    int pvLength[MAX_SEARCH_PLY];
+    Move killers[MAX_SEARCH_PLY][2]; // quiet moves that caused a cutoff at each ply
+    uint64_t keyHistory[MAX_SEARCH_PLY]; // hash of each position on the current line
+    vector<uint64_t> gameKeys; // positions played before the root, back to the last capture or pawn move
+    NnueAccumulator accumulators[MAX_SEARCH_PLY]; // network inputs of each position on the line, when a network is loaded
+
+    double elapsedSeconds() const {
+        return chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    }
+
+    void countNode() {
+        long long count = nodes.load(memory_order_relaxed) + 1;
+        nodes.store(count, memory_order_relaxed);
+        if (sharedNodes && count % NODE_BATCH == 0) {
+            sharedTotal = sharedNodes->fetch_add(NODE_BATCH, memory_order_relaxed) + NODE_BATCH;
+        }
+    }
+
+    // Polled every node, the clock only every NODE_BATCH nodes. The node limit
+    // applies to all threads together, so each may pass it by up to a batch.
+    bool shouldStop() {
+        if (!stopped) {
+            long long count = nodes.load(memory_order_relaxed);
+            long long searched = (sharedNodes) ? sharedTotal + count % NODE_BATCH : count;
+            stopped = (limits.maxNodes && searched >= limits.maxNodes)
+                || (limits.maxSeconds > 0 && count % NODE_BATCH == 0 && elapsedSeconds() >= limits.maxSeconds)
+                || (stopSignal && stopSignal->load(memory_order_relaxed));
+        }
+        return stopped;
+    }
+
+    bool isCapture(const Move& move) const {
+        return board.getPiece(move.to).isActive()
+            || (move.to == board.getEnPassantMove() && board.getPiece(move.from).isOfType(PieceType::PAWN));
+    }
+
+    // Hash move first, then captures by most valuable victim and least valuable attacker, then killers
+    void scoreMoves(const MoveList& moves, int scores[], const Move& hashMove, int ply) const {
+        for (int i = 0; i < moves.size(); i++) {
+            const Move& move = moves[i];
+            if (move == hashMove) {
+                scores[i] = 1000000;
+            }
+            else if (isCapture(move) || move.promotion != PieceType::EMPTY) {
+                PieceType victim = board.getPiece(move.to).getType();
+                int gain = Evaluation::pieceValue(victim) + Evaluation::pieceValue(move.promotion);
+                scores[i] = 100000 + 10 * gain - (int)board.getPiece(move.from).getType();
+            }
+            else if (move == killers[ply][0]) {
+                scores[i] = 90000;
+            }
+            else if (move == killers[ply][1]) {
+                scores[i] = 80000;
+            }
+            else {
+                scores[i] = 0;
+            }
+        }
+    }
+
+    // Swaps the best scored move not searched yet into position i
+    static void pickMove(MoveList& moves, int scores[], int i) {
+        int best = i;
+        for (int j = i + 1; j < moves.size(); j++) {
+            if (scores[j] > scores[best]) {
+                best = j;
+            }
+        }
+        swap(moves[i], moves[best]);
+        swap(scores[i], scores[best]);
+    }
+
+    // Picks the root move by tablebase distance to zeroing: the quickest win
+    // the fifty move rule cannot spoil, the slowest loss. False if not covered.
+    bool probeRoot(const MoveList& rootMoves, SearchResult& result) {
+        int ranks[MAX_MOVES];
+        if (!Tablebase::rankRootMoves(board, validator, executor, rootMoves, ranks)) {
+            return false;
+        }
+        int best = 0;
+        for (int i = 1; i < rootMoves.size(); i++) {
+            if (ranks[i] > ranks[best]) {
+                best = i;
+            }
+        }
+        result.bestMove = rootMoves[best];
+        result.score = (ranks[best] > Tablebase::CERTAIN_RANK) ? TABLEBASE_WIN_SCORE : (ranks[best] < -Tablebase::CERTAIN_RANK) ? -TABLEBASE_WIN_SCORE : 0;
+        result.depth = 1;
+        result.pv.assign(1, result.bestMove);
+        return true;
+    }
+
+    // Moves on the current line go through here so the network inputs follow the board
+    void makeMove(const Move& move, int ply) {
+        if (Nnue::isLoaded()) {
+            Nnue::update(board, move, accumulators[ply], accumulators[ply + 1]);
+        }
+        executor.makeMove(move);
+    }
+
+    int evaluate(int ply) const {
+        return (Nnue::isLoaded()) ? Nnue::evaluate(accumulators[ply], board.getSideToMove()) : Evaluation::evaluate(board);
+    }
+
+    void updatePv(int ply, const Move& move) {
+        pvTable[ply][ply] = move;
+        for (int i = ply + 1; i < pvLength[ply + 1]; i++) {
+            pvTable[ply][i] = pvTable[ply + 1][i];
+        }
+        pvLength[ply] = pvLength[ply + 1];
+    }
+
+    // Mate and tablebase scores are stored relative to the position, not the root
+    static int scoreToTable(int score, int ply) {
+        return (score > TABLEBASE_WIN_SCORE - MAX_SEARCH_PLY) ? score + ply : (score < -TABLEBASE_WIN_SCORE + MAX_SEARCH_PLY) ? score - ply : score;
+    }
+
+    static int scoreFromTable(int score, int ply) {
+        return (score > TABLEBASE_WIN_SCORE - MAX_SEARCH_PLY) ? score - ply : (score < -TABLEBASE_WIN_SCORE + MAX_SEARCH_PLY) ? score + ply : score;
+    }
+
+    // A position seen before with the same side to move, on this line or in the game
+    bool isRepetition(int ply) const {
+        int i = ply - 2;
+        for (; i >= 0; i -= 2) {
+            if (keyHistory[i] == keyHistory[ply]) {
+                return true;
+            }
+        }
+        // i is now -1 or -2, the ply before the root with the same side to move
+        for (int g = (int)gameKeys.size() + i; g >= 0; g -= 2) {
+            if (gameKeys[g] == keyHistory[ply]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Only captures and promotions are searched until the position is quiet
+    int quiescence(int alpha, int beta, int ply) {
+        countNode();
+        pvLength[ply] = ply;
+        if (shouldStop()) {
+            return 0;
+        }
+        bool inCheck = validator.getGenerator().isInCheck(board.getSideToMove());
+        if (ply >= MAX_SEARCH_PLY - 1) {
+            return evaluate(ply);
+        }
+        int best = -INFINITE_SCORE;
+        if (!inCheck) {
+            best = evaluate(ply);
+            if (best >= beta) {
+                return best;
+            }
+            alpha = max(alpha, best);
+        }
+
+        MoveList moves;
+        validator.getLegalMoves(moves);
+        if (moves.empty()) {
+            return (inCheck) ? -MATE_SCORE + ply : 0;
+        }
+        int scores[MAX_MOVES];
+        scoreMoves(moves, scores, Move(), ply);
+        for (int i = 0; i < moves.size(); i++) {
+            pickMove(moves, scores, i);
+            const Move& move = moves[i];
+            if (!inCheck && !isCapture(move) && move.promotion == PieceType::EMPTY) {
+                break; // the rest are quiet
+            }
+            makeMove(move, ply);
+            int score = -quiescence(-beta, -alpha, ply + 1);
+            executor.unmakeMove();
+            if (stopped) {
+                return 0;
+            }
+            if (score > best) {
+                best = score;
+                if (score > alpha) {
+                    alpha = score;
+                    updatePv(ply, move);
+                    if (alpha >= beta) {
+                        break;
+                    }
+                }
+            }
+        }
+        return best;
+    }
+
+    int negamax(int depth, int alpha, int beta, int ply) {
+        pvLength[ply] = ply;
+        keyHistory[ply] = board.getHash();
+        if (ply > 0 && isRepetition(ply)) {
+            return 0;
+        }
+        // Positions in the tablebase need no search. Right after a capture or
+        // pawn move the fifty move rule cannot change the stored result.
+        int wdl;
+        if (ply > 0 && board.getHalfmoveClock() == 0 && Tablebase::probeWdl(board, validator, executor, wdl)) {
+            countNode();
+            return (wdl == Tablebase::WIN) ? TABLEBASE_WIN_SCORE - ply : (wdl == Tablebase::LOSS) ? -TABLEBASE_WIN_SCORE + ply : 0;
+        }
+        bool inCheck = validator.getGenerator().isInCheck(board.getSideToMove());
+        if (inCheck) {
+            depth++;
+        }
+        if (depth <= 0 || ply >= MAX_SEARCH_PLY - 1) {
+            return quiescence(alpha, beta, ply);
+        }
+        countNode();
+        if (shouldStop()) {
+            return 0;
+        }
+
+        Move hashMove;
+        TTEntry entry;
+        if (table->probe(board.getHash(), entry, tableStats)) {
+            hashMove = entry.move;
+            int score = scoreFromTable(entry.score, ply);
+            if (ply > 0 && entry.depth >= depth && (entry.bound == Bound::EXACT
+                || (entry.bound == Bound::LOWER && score >= beta) || (entry.bound == Bound::UPPER && score <= alpha))) {
+                return score;
+            }
+        }
+
+        MoveList moves;
+        validator.getLegalMoves(moves);
+        if (moves.empty()) {
+            return (inCheck) ? -MATE_SCORE + ply : 0;
+        }
+        int scores[MAX_MOVES];
+        scoreMoves(moves, scores, hashMove, ply);
+
+        int originalAlpha = alpha;
+        int best = -INFINITE_SCORE;
+        Move bestMove;
+        for (int i = 0; i < moves.size(); i++) {
+            pickMove(moves, scores, i);
+            const Move& move = moves[i];
+            bool quiet = !isCapture(move) && move.promotion == PieceType::EMPTY;
+            makeMove(move, ply);
+            int score;
+            if (i == 0) {
+                score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+            }
+            else {
+                // Later moves only need to prove they are worse than the first
+                score = -negamax(depth - 1, -alpha - 1, -alpha, ply + 1);
+                if (score > alpha && score < beta) {
+                    score = -negamax(depth - 1, -beta, -alpha, ply + 1);
+                }
+            }
+            executor.unmakeMove();
+            if (stopped) {
+                return 0;
+            }
+            if (score > best) {
+                best = score;
+                bestMove = move;
+                if (score > alpha) {
+                    alpha = score;
+                    updatePv(ply, move);
+                    if (alpha >= beta) {
+                        if (quiet && move != killers[ply][0]) {
+                            killers[ply][1] = killers[ply][0];
+                            killers[ply][0] = move;
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+
+        Bound bound = (best <= originalAlpha) ? Bound::UPPER : (best >= beta) ? Bound::LOWER : Bound::EXACT;
+        table->store(board.getHash(), bestMove, scoreToTable(best, ply), depth, bound);
+        return best;
+    }
+
+public:
+    Search(const Board& position, TranspositionTable& table, const atomic<bool>* stopSignal = nullptr, atomic<long long>* sharedNodes = nullptr)
+        : board(position), validator(&board), executor(&board, &validator), table(&table), nodes(0), sharedNodes(sharedNodes), stopSignal(stopSignal) {
+        sharedTotal = 0;
+        stopped = false;
+    }
+
+    // Hashes of the game positions before the root, oldest first, so the
+    // search sees repetitions of them. Only positions since the last capture
+    // or pawn move are needed.
+    void setGameHistory(const vector<uint64_t>& keys) {
+        gameKeys = keys;
+    }
+
+    // Deepens one ply at a time from firstDepth until a limit is hit, onIteration is called after each completed depth
+    SearchResult run(const SearchLimits& searchLimits, function<void(const SearchResult&)> onIteration = nullptr, int firstDepth = 1) {
+        limits = searchLimits;
+        startTime = chrono::steady_clock::now();
+        nodes = 0;
+        sharedTotal = 0;
+        tableStats = TTStats();
+        stopped = false;
+        for (int ply = 0; ply < MAX_SEARCH_PLY; ply++) {
+            killers[ply][0] = killers[ply][1] = Move();
+        }
+        SearchResult result;
+        MoveList rootMoves;
+        validator.getLegalMoves(rootMoves);
+        if (rootMoves.empty()) {
+            return result;
+        }
+        result.bestMove = rootMoves[0];
+        if (Nnue::isLoaded()) {
+            Nnue::refresh(board, accumulators[0]);
+        }
+        if (probeRoot(rootMoves, result)) {
+            result.seconds = elapsedSeconds();
+            if (onIteration) {
+                onIteration(result);
+            }
+            return result;
+        }
+
+        for (int depth = firstDepth; depth <= min(limits.maxDepth, MAX_SEARCH_PLY - 1); depth++) {
+            int score = negamax(depth, -INFINITE_SCORE, INFINITE_SCORE, 0);
+            if (stopped) {
+                break; // an unfinished iteration is not trusted
+            }
+            result.score = score;
+            result.depth = depth;
+            result.pv.assign(pvTable[0], pvTable[0] + pvLength[0]);
+            if (!result.pv.empty()) {
+                result.bestMove = result.pv.front();
+            }
+            result.nodes = nodes;
+            result.seconds = elapsedSeconds();
+            result.tableStats = tableStats;
+            if (onIteration) {
+                onIteration(result);
+            }
+            // The next iteration takes longer than all before it together
+            if (limits.maxSeconds > 0 && result.seconds > limits.maxSeconds / 2) {
+                break;
+            }
+        }
+        result.nodes = nodes;
+        result.seconds = elapsedSeconds();
+        result.tableStats = tableStats;
+        return result;
+    }
+
+    long long getNodes() const { return nodes; }
+
+    // Only read once the search has returned
+    const TTStats& getTableStats() const { return tableStats; }
+};
@@ -0,0 +1,1056 @@
+// Syzygy tablebase probing.
+//
+// Derived from src/syzygy/tbprobe.cpp of Stockfish, Copyright (C) The
+// Stockfish developers, which is based on the original probing code by
+// Ronald de Man. Adapted to this engine's board and move generation.
+//
+// This file is free software: you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation, either version 3 of the License, or (at your
+// option) any later version. It is distributed WITHOUT ANY WARRANTY; the
+// license text is in COPYING.GPL-3 next to this file.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "Tablebase.h"
+#include "../moves/LeaperTables.h"
+#include "../moves/MoveValidator.h"
+#include "../moves/MoveExecutor.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CHESS_HAS_MMAP
+#endif
+
+static const uint8_t WDL_MAGIC[4] = { 0x71, 0xE8, 0x23, 0x5D };
+static const uint8_t DTZ_MAGIC[4] = { 0xD7, 0x66, 0x0C, 0xA5 };
+
+// Flags of one part of a table
+const int FLAG_STM = 1; // DTZ: the part is stored for black to move
+const int FLAG_MAPPED = 2; // DTZ: values go through a map
+const int FLAG_WIN_PLIES = 4; // DTZ: wins are in plies, not moves
+const int FLAG_LOSS_PLIES = 8;
+const int FLAG_WIDE = 16; // DTZ: the map holds 16 bit values
+const int FLAG_SINGLE_VALUE = 128; // every position has the same value
+
+const int NO_SYMBOL = 0xFFF;
+
+#ifdef _WIN32
+const char PATH_SEPARATOR = ';';
+#else
+const char PATH_SEPARATOR = ':';
+#endif
+
+// One compressed part of a table: a side to move, and for pawn tables a
+// file of the leading pawn. Values are Huffman coded symbols that each
+// expand to a run of values through a binary tree of symbol pairs.
+struct SyzygyPairs {
+    int flags = 0;
+    size_t blockSize = 0;
+    size_t span = 0; // every span values there is a sparse index entry
+    size_t sparseIndexSize = 0;
+    uint32_t blockCount = 0;
+    uint32_t blockLengthSize = 0; // blockCount plus padding
+    int minSymbolLength = 0; // the value itself for FLAG_SINGLE_VALUE
+    const uint8_t* lowestSymbols = nullptr; // uint16 per code length, the lowest symbol of that length
+    const uint8_t* tree = nullptr; // 3 bytes per symbol, two 12 bit children
+    const uint8_t* sparseIndex = nullptr; // 6 bytes per entry, uint32 block and uint16 offset
+    const uint8_t* blockLengths = nullptr; // uint16 per block, values stored minus one
+    const uint8_t* data = nullptr;
+    vector<uint64_t> base64; // lowest code of each length, left aligned in 64 bits
+    vector<uint8_t> symbolLengths; // values a symbol expands to, minus one
+    uint8_t pieces[Tablebase::MAX_PIECES] = {}; // piece codes in the order of the index
+    uint64_t groupIndex[Tablebase::MAX_PIECES + 1] = {};
+    int groupLength[Tablebase::MAX_PIECES + 1] = {}; // pieces in each group, zero terminated
+    uint16_t mapIndex[4] = {}; // DTZ: where the map of each result starts
+};
+
+// A .rtbw or .rtbz file of one material, named with the stronger side first
+struct SyzygyTable {
+    string name; // e.g. KRPvKR
+    bool dtz;
+    uint64_t key; // material with the first named side white
+    uint64_t key2; // and black
+    int pieceCount;
+    bool hasPawns;
+    bool hasUniquePieces;
+    int pawnCount[2]; // the side of the leading pawns, then the other
+
+    atomic<bool> ready;
+    const uint8_t* base;
+    size_t mappedBytes; // 0 when the file was read into buffer
+    vector<uint8_t> buffer;
+    const uint8_t* map; // DTZ value maps
+    SyzygyPairs parts[2][4]; // [side to move for WDL][file of the leading pawn]
+
+    SyzygyTable(const string& name, bool dtz) : name(name), dtz(dtz), ready(false), base(nullptr), mappedBytes(0), map(nullptr) {}
+
+    SyzygyPairs* get(int stm, int file) {
+        return &parts[(dtz) ? 0 : stm][(hasPawns) ? file : 0];
+    }
+};
+
+enum class ProbeState {
+    FAIL,
+    OK,
+    CHANGE_SIDE, // DTZ stored for the other side to move only
+    ZEROING_BEST_MOVE // the best move captures or moves a pawn
+};
+
+// Index tables, filled in once
+static int mapB1H1H7[64]; // squares below the a1-h8 diagonal to 0..27
+static int mapA1D1D4[64]; // the a1-d1-d4 triangle to 0..9, diagonal squares last
+static int mapKK[10][64]; // the 462 placements of two kings, the first in the triangle
+static int mapPawns[64]; // a2-h7 to 0..47, the highest is the leading pawn
+static uint64_t binomial[Tablebase::MAX_PIECES][64]; // [k][n] ways to choose k of n
+static int leadPawnIndex[6][64];
+static int leadPawnsSize[6][4];
+static once_flag indexTablesFlag;
+
+static string searchPaths;
+static int maxPieces = 0;
+static deque<SyzygyTable> wdlTables;
+static deque<SyzygyTable> dtzTables; // same order as wdlTables
+static unordered_map<uint64_t, size_t> tableIndex; // material key to position in the tables
+static mutex loadLock;
+
+static uint64_t readBigEndian(const uint8_t* bytes, int size) {
+    uint64_t value = 0;
+    for (int i = 0; i < size; i++) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static uint32_t readLittleEndian(const uint8_t* bytes, int size) {
+    uint32_t value = 0;
+    for (int i = size - 1; i >= 0; i--) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+static int offDiagonal(int pos) {
+    return pos / 8 - pos % 8;
+}
+
+static int signOf(int value) {
+    return (value > 0) - (value < 0);
+}
+
+static void buildIndexTables() {
+    int code = 0;
+    for (int pos = 0; pos < 64; pos++) {
+        if (offDiagonal(pos) < 0) {
+            mapB1H1H7[pos] = code++;
+        }
+    }
+
+    vector<int> diagonal;
+    code = 0;
+    for (int pos = 0; pos <= 27; pos++) {
+        if (offDiagonal(pos) < 0 && pos % 8 <= 3) {
+            mapA1D1D4[pos] = code++;
+        }
+        else if (!offDiagonal(pos) && pos % 8 <= 3) {
+            diagonal.push_back(pos);
+        }
+    }
+    for (int pos : diagonal) {
+        mapA1D1D4[pos] = code++;
+    }
+
+    // Kings may not touch. With the first king on the diagonal the second
+    // stays on or below it, and both on the diagonal are numbered last.
+    vector<pair<int, int>> bothOnDiagonal;
+    code = 0;
+    for (int index = 0; index < 10; index++) {
+        for (int first = 0; first <= 27; first++) {
+            if (mapA1D1D4[first] != index || (!index && first != 1)) {
+                continue; // b1 is mapped to 0
+            }
+            for (int second = 0; second < 64; second++) {
+                if ((LeaperTables::king[first] | squareBit(first)) & squareBit(second)) {
+                    continue;
+                }
+                if (!offDiagonal(first) && offDiagonal(second) > 0) {
+                    continue;
+                }
+                if (!offDiagonal(first) && !offDiagonal(second)) {
+                    bothOnDiagonal.emplace_back(index, second);
+                }
+                else {
+                    mapKK[index][second] = code++;
+                }
+            }
+        }
+    }
+    for (const pair<int, int>& kings : bothOnDiagonal) {
+        mapKK[kings.first][kings.second] = code++;
+    }
+
+    binomial[0][0] = 1;
+    for (int n = 1; n < 64; n++) {
+        for (int k = 0; k < Tablebase::MAX_PIECES && k <= n; k++) {
+            binomial[k][n] = ((k > 0) ? binomial[k - 1][n - 1] : 0) + ((k < n) ? binomial[k][n - 1] : 0);
+        }
+    }
+
+    // Each table of a pawn material is split by the file of the leading pawn
+    int availableSquares = 47;
+    for (int leadPawns = 1; leadPawns <= 5; leadPawns++) {
+        for (int file = 0; file < 4; file++) {
+            int index = 0;
+            for (int rank = 1; rank <= 6; rank++) {
+                int pos = rank * 8 + file;
+                if (leadPawns == 1) {
+                    mapPawns[pos] = availableSquares--;
+                    mapPawns[pos ^ 7] = availableSquares--;
+                }
+                leadPawnIndex[leadPawns][pos] = index;
+                index += (int)binomial[leadPawns - 1][mapPawns[pos]];
+            }
+            leadPawnsSize[leadPawns][file] = index;
+        }
+    }
+}
+
+// Piece counts packed four bits apiece, the white side in the low half
+static uint64_t materialKey(const int counts[2][7]) {
+    uint64_t key = 0;
+    for (int side = 0; side < 2; side++) {
+        for (int type = 1; type <= 6; type++) {
+            key |= (uint64_t)counts[side][type] << (4 * (6 * side + type - 1));
+        }
+    }
+    return key;
+}
+
+static uint64_t materialKey(const Board& board) {
+    const BitboardPosition& bb = board.getBitboards();
+    int counts[2][7] = {};
+    for (int type = 1; type <= 6; type++) {
+        counts[0][type] = popCount(bb.getPieces((PieceType)type, PieceSide::WHITE));
+        counts[1][type] = popCount(bb.getPieces((PieceType)type, PieceSide::BLACK));
+    }
+    return materialKey(counts);
+}
+
+// Piece code used in the files: the type, plus 8 for black
+static int pieceCode(const ChessPiece& piece) {
+    return (int)piece.getType() | ((piece.getSide() == PieceSide::BLACK) ? 8 : 0);
+}
+
+static bool pawnOrder(int first, int second) {
+    return mapPawns[first] < mapPawns[second];
+}
+
+static void initTableInfo(SyzygyTable& table) {
+    const char letters[] = " PNBRQK";
+    int counts[2][7] = {};
+    int side = 0;
+    for (char letter : table.name) {
+        if (letter == 'v') {
+            side = 1;
+        }
+        else {
+            counts[side][strchr(letters, letter) - letters]++;
+        }
+    }
+    table.key = materialKey(counts);
+    swap(counts[0], counts[1]);
+    table.key2 = materialKey(counts);
+    swap(counts[0], counts[1]);
+
+    table.pieceCount = 0;
+    table.hasUniquePieces = false;
+    for (int s = 0; s < 2; s++) {
+        for (int type = 1; type <= 6; type++) {
+            table.pieceCount += counts[s][type];
+            table.hasUniquePieces |= type != 6 && counts[s][type] == 1;
+        }
+    }
+    table.hasPawns = counts[0][1] || counts[1][1];
+
+    // The side with fewer pawns leads, it compresses better
+    bool firstLeads = !counts[1][1] || (counts[0][1] && counts[1][1] >= counts[0][1]);
+    table.pawnCount[0] = counts[(firstLeads) ? 0 : 1][1];
+    table.pawnCount[1] = counts[(firstLeads) ? 1 : 0][1];
+}
+
+// The order of the groups in the index is a parameter of each part
+static void setGroups(const SyzygyTable& table, SyzygyPairs* d, const int order[2], int file) {
+    int n = 0, firstLength = (table.hasPawns) ? 0 : (table.hasUniquePieces) ? 3 : 2;
+    d->groupLength[n] = 1;
+    for (int i = 1; i < table.pieceCount; i++) {
+        if (--firstLength > 0 || d->pieces[i] == d->pieces[i - 1]) {
+            d->groupLength[n]++;
+        }
+        else {
+            d->groupLength[++n] = 1;
+        }
+    }
+    d->groupLength[++n] = 0;
+
+    bool bothPawns = table.hasPawns && table.pawnCount[1];
+    int next = (bothPawns) ? 2 : 1;
+    int freeSquares = 64 - d->groupLength[0] - ((bothPawns) ? d->groupLength[1] : 0);
+    uint64_t index = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; k++) {
+        if (k == order[0]) {
+            d->groupIndex[0] = index;
+            index *= (table.hasPawns) ? leadPawnsSize[d->groupLength[0]][file] : (table.hasUniquePieces) ? 31332 : 462;
+        }
+        else if (k == order[1]) {
+            d->groupIndex[1] = index;
+            index *= binomial[d->groupLength[1]][48 - d->groupLength[0]];
+        }
+        else {
+            d->groupIndex[next] = index;
+            index *= binomial[d->groupLength[next]][freeSquares];
+            freeSquares -= d->groupLength[next++];
+        }
+    }
+    d->groupIndex[n] = index;
+}
+
+static int lowestSymbol(const SyzygyPairs* d, int length) {
+    return (int)readLittleEndian(d->lowestSymbols + 2 * length, 2);
+}
+
+static int leftChild(const SyzygyPairs* d, int symbol) {
+    const uint8_t* pair = d->tree + 3 * symbol;
+    return ((pair[1] & 0xF) << 8) | pair[0];
+}
+
+static int rightChild(const SyzygyPairs* d, int symbol) {
+    const uint8_t* pair = d->tree + 3 * symbol;
+    return (pair[2] << 4) | (pair[1] >> 4);
+}
+
+static int blockLength(const SyzygyPairs* d, uint32_t block) {
+    return (int)readLittleEndian(d->blockLengths + 2 * block, 2);
+}
+
+// Values a symbol expands to, minus one. The tree has no cycles.
+static uint8_t setSymbolLength(SyzygyPairs* d, int symbol, vector<bool>& visited) {
+    visited[symbol] = true;
+    int right = rightChild(d, symbol);
+    if (right == NO_SYMBOL) {
+        return 0;
+    }
+    int left = leftChild(d, symbol);
+    if (left >= (int)visited.size() || right >= (int)visited.size()) {
+        return 0; // damaged file
+    }
+    if (!visited[left]) {
+        d->symbolLengths[left] = setSymbolLength(d, left, visited);
+    }
+    if (!visited[right]) {
+        d->symbolLengths[right] = setSymbolLength(d, right, visited);
+    }
+    return d->symbolLengths[left] + d->symbolLengths[right] + 1;
+}
+
+// Reads the header of a part, nullptr if it runs past the end of the file
+static const uint8_t* setSizes(SyzygyPairs* d, const uint8_t* data, const uint8_t* end) {
+    d->flags = *data++;
+    if (d->flags & FLAG_SINGLE_VALUE) {
+        d->minSymbolLength = *data++;
+        return data;
+    }
+
+    int groups = 0;
+    while (d->groupLength[groups]) {
+        groups++;
+    }
+    uint64_t tableSize = d->groupIndex[groups];
+    d->blockSize = (size_t)1 << *data++;
+    d->span = (size_t)1 << *data++;
+    d->sparseIndexSize = (size_t)((tableSize + d->span - 1) / d->span);
+    int padding = *data++;
+    d->blockCount = readLittleEndian(data, 4);
+    data += 4;
+    d->blockLengthSize = d->blockCount + padding;
+    int maxSymbolLength = *data++;
+    d->minSymbolLength = *data++;
+    int lengths = maxSymbolLength - d->minSymbolLength + 1;
+    if (lengths < 1 || d->minSymbolLength < 1 || data + 2 * lengths + 2 > end) {
+        return nullptr;
+    }
+    d->lowestSymbols = data;
+
+    // Longer codes have lower values, so base64 falls as the length grows
+    d->base64.assign(lengths, 0);
+    for (int i = lengths - 2; i >= 0; i--) {
+        d->base64[i] = (d->base64[i + 1] + lowestSymbol(d, i) - lowestSymbol(d, i + 1)) / 2;
+    }
+    for (int i = 0; i < lengths; i++) {
+        d->base64[i] <<= 64 - i - d->minSymbolLength;
+    }
+    data += 2 * lengths;
+
+    int symbolCount = (int)readLittleEndian(data, 2);
+    data += 2;
+    if (data + 3 * symbolCount > end) {
+        return nullptr;
+    }
+    d->tree = data;
+    d->symbolLengths.assign(symbolCount, 0);
+    vector<bool> visited(symbolCount);
+    for (int symbol = 0; symbol < symbolCount; symbol++) {
+        if (!visited[symbol]) {
+            d->symbolLengths[symbol] = setSymbolLength(d, symbol, visited);
+        }
+    }
+    return data + 3 * symbolCount + (symbolCount & 1);
+}
+
+static const uint8_t* setDtzMap(SyzygyTable& table, const uint8_t* data, int maxFile) {
+    table.map = data;
+    for (int file = 0; file <= maxFile; file++) {
+        SyzygyPairs* d = table.get(0, file);
+        if (!(d->flags & FLAG_MAPPED)) {
+            continue;
+        }
+        if (d->flags & FLAG_WIDE) {
+            data += (data - table.base) & 1;
+            for (int i = 0; i < 4; i++) {
+                d->mapIndex[i] = (uint16_t)((data - table.map) / 2 + 1);
+                data += 2 * readLittleEndian(data, 2) + 2;
+            }
+        }
+        else {
+            for (int i = 0; i < 4; i++) {
+                d->mapIndex[i] = (uint16_t)(data - table.map + 1);
+                data += *data + 1;
+            }
+        }
+    }
+    return data + ((data - table.base) & 1);
+}
+
+// Sets up the parts of a mapped file, false if the file is damaged
+static bool initTable(SyzygyTable& table, size_t size) {
+    const uint8_t* base = table.base;
+    const uint8_t* end = base + size;
+    const uint8_t* data = base + 5; // the magic and a flags byte
+    int sides = (!table.dtz && table.key != table.key2) ? 2 : 1;
+    int maxFile = (table.hasPawns) ? 3 : 0;
+    bool bothPawns = table.hasPawns && table.pawnCount[1];
+
+    for (int file = 0; file <= maxFile; file++) {
+        for (int i = 0; i < sides; i++) {
+            *table.get(i, file) = SyzygyPairs();
+        }
+        int order[2][2] = { { data[0] & 0xF, (bothPawns) ? data[1] & 0xF : 0xF },
+                            { data[0] >> 4, (bothPawns) ? data[1] >> 4 : 0xF } };
+        data += 1 + bothPawns;
+        for (int k = 0; k < table.pieceCount; k++, data++) {
+            for (int i = 0; i < sides; i++) {
+                table.get(i, file)->pieces[k] = (i) ? *data >> 4 : *data & 0xF;
+            }
+        }
+        for (int i = 0; i < sides; i++) {
+            setGroups(table, table.get(i, file), order[i], file);
+        }
+    }
+    data += (data - base) & 1;
+
+    for (int file = 0; file <= maxFile; file++) {
+        for (int i = 0; i < sides; i++) {
+            data = setSizes(table.get(i, file), data, end);
+            if (!data) {
+                return false;
+            }
+        }
+    }
+    if (table.dtz) {
+        data = setDtzMap(table, data, maxFile);
+    }
+    for (int file = 0; file <= maxFile; file++) {
+        for (int i = 0; i < sides; i++) {
+            SyzygyPairs* d = table.get(i, file);
+            d->sparseIndex = data;
+            data += 6 * d->sparseIndexSize;
+        }
+    }
+    for (int file = 0; file <= maxFile; file++) {
+        for (int i = 0; i < sides; i++) {
+            SyzygyPairs* d = table.get(i, file);
+            d->blockLengths = data;
+            data += 2 * (size_t)d->blockLengthSize;
+        }
+    }
+    for (int file = 0; file <= maxFile; file++) {
+        for (int i = 0; i < sides; i++) {
+            SyzygyPairs* d = table.get(i, file);
+            data = base + (((data - base) + 63) & ~(ptrdiff_t)63);
+            d->data = data;
+            data += d->blockCount * d->blockSize;
+        }
+    }
+    return data <= end;
+}
+
+static void closeTable(SyzygyTable& table) {
+#ifdef CHESS_HAS_MMAP
+    if (table.mappedBytes) {
+        munmap((void*)table.base, table.mappedBytes);
+    }
+#endif
+    table.buffer = vector<uint8_t>();
+    table.base = table.map = nullptr;
+    table.mappedBytes = 0;
+}
+
+// Maps the file from the first directory that has it. Valid files are 16
+// bytes longer than a multiple of 64.
+static bool openTable(SyzygyTable& table, size_t& size) {
+    size_t start = 0;
+    while (start <= searchPaths.size()) {
+        size_t separator = searchPaths.find(PATH_SEPARATOR, start);
+        if (separator == string::npos) {
+            separator = searchPaths.size();
+        }
+        string path = searchPaths.substr(start, separator - start) + "/" + table.name + ((table.dtz) ? ".rtbz" : ".rtbw");
+        start = separator + 1;
+#ifdef CHESS_HAS_MMAP
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            continue;
+        }
+        struct stat info;
+        void* mapping = MAP_FAILED;
+        if (fstat(descriptor, &info) == 0 && info.st_size % 64 == 16) {
+            mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        }
+        ::close(descriptor);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        madvise(mapping, info.st_size, MADV_RANDOM);
+        table.base = (const uint8_t*)mapping;
+        table.mappedBytes = size = info.st_size;
+#else
+        ifstream file(path, ios::binary);
+        if (!file) {
+            continue;
+        }
+        table.buffer.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        if (table.buffer.size() % 64 != 16) {
+            table.buffer = vector<uint8_t>();
+            return false;
+        }
+        table.base = table.buffer.data();
+        size = table.buffer.size();
+#endif
+        if (memcmp(table.base, (table.dtz) ? DTZ_MAGIC : WDL_MAGIC, 4) != 0) {
+            closeTable(table);
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Maps a table on its first use, false if its file is missing or damaged
+static bool loadTable(SyzygyTable& table) {
+    if (!table.ready.load(memory_order_acquire)) {
+        lock_guard<mutex> guard(loadLock);
+        if (!table.ready.load(memory_order_relaxed)) {
+            size_t size;
+            if (openTable(table, size) && !initTable(table, size)) {
+                closeTable(table);
+            }
+            table.ready.store(true, memory_order_release);
+        }
+    }
+    return table.base;
+}
+
+// Finds the stored value for a position index
+static int decompressPairs(const SyzygyPairs* d, uint64_t index) {
+    if (d->flags & FLAG_SINGLE_VALUE) {
+        return d->minSymbolLength;
+    }
+
+    // Sparse entry k gives the block and offset of value k * span + span / 2,
+    // the block lengths lead from there to the block holding the index
+    uint32_t k = (uint32_t)(index / d->span);
+    const uint8_t* sparse = d->sparseIndex + 6 * (size_t)k;
+    uint32_t block = readLittleEndian(sparse, 4);
+    int offset = (int)readLittleEndian(sparse + 4, 2) + (int)(index % d->span) - (int)(d->span / 2);
+    while (offset < 0) {
+        offset += blockLength(d, --block) + 1;
+    }
+    while (offset > blockLength(d, block)) {
+        offset -= blockLength(d, block++) + 1;
+    }
+
+    // Skips whole symbols until the one whose run covers the offset
+    const uint8_t* next = d->data + (uint64_t)block * d->blockSize;
+    uint64_t bits = readBigEndian(next, 8);
+    next += 8;
+    int bitCount = 64;
+    int symbol;
+    while (true) {
+        int length = 0;
+        while (bits < d->base64[length]) {
+            length++;
+        }
+        symbol = (int)((bits - d->base64[length]) >> (64 - length - d->minSymbolLength)) + lowestSymbol(d, length);
+        if (offset < d->symbolLengths[symbol] + 1) {
+            break;
+        }
+        offset -= d->symbolLengths[symbol] + 1;
+        length += d->minSymbolLength;
+        bits <<= length;
+        bitCount -= length;
+        if (bitCount <= 32) {
+            bitCount += 32;
+            bits |= readBigEndian(next, 4) << (64 - bitCount);
+            next += 4;
+        }
+    }
+
+    // The pairs of a symbol are adjacent runs, descend to the one value
+    while (d->symbolLengths[symbol]) {
+        int left = leftChild(d, symbol);
+        if (offset < d->symbolLengths[left] + 1) {
+            symbol = left;
+        }
+        else {
+            offset -= d->symbolLengths[left] + 1;
+            symbol = rightChild(d, symbol);
+        }
+    }
+    return leftChild(d, symbol);
+}
+
+// DTZ values are stored in moves or plies and may go through a map
+static int mapDtz(SyzygyTable& table, int file, int value, int wdl) {
+    const int MAP_OF_RESULT[] = { 1, 3, 0, 2, 0 }; // by wdl + 2
+    const SyzygyPairs* d = table.get(0, file);
+    if (d->flags & FLAG_MAPPED) {
+        int i = d->mapIndex[MAP_OF_RESULT[wdl + 2]] + value;
+        value = (d->flags & FLAG_WIDE) ? (int)readLittleEndian(table.map + 2 * i, 2) : table.map[i];
+    }
+    if ((wdl == Tablebase::WIN && !(d->flags & FLAG_WIN_PLIES)) || (wdl == Tablebase::LOSS && !(d->flags & FLAG_LOSS_PLIES))
+        || wdl == Tablebase::CURSED_WIN || wdl == Tablebase::BLESSED_LOSS) {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+// Value of a position in one table: WDL for .rtbw, DTZ for .rtbz given the WDL
+static int readTable(const Board& board, SyzygyTable& table, int wdl, ProbeState& state) {
+    const BitboardPosition& bb = board.getBitboards();
+    int squares[Tablebase::MAX_PIECES], pieces[Tablebase::MAX_PIECES];
+    int size = 0, leadPawnCount = 0, file = 0;
+    Bitboard leadPawns = 0;
+
+    // Files have the first named side as white, and when both sides have the
+    // same pieces only white to move. Other positions are looked up with the
+    // colours swapped and the board mirrored.
+    bool blackToMove = board.getSideToMove() == PieceSide::BLACK;
+    bool flip = (table.key == table.key2) ? blackToMove : materialKey(board) != table.key;
+    int flipColor = (flip) ? 8 : 0, flipSquares = (flip) ? 56 : 0;
+    int stm = flip ^ blackToMove;
+
+    // Pawn tables have a part for each file a to d of the leading pawn
+    if (table.hasPawns) {
+        int leadPiece = table.get(0, 0)->pieces[0] ^ flipColor;
+        Bitboard pawns = leadPawns = bb.getPieces(PieceType::PAWN, (leadPiece & 8) ? PieceSide::BLACK : PieceSide::WHITE);
+        while (pawns) {
+            squares[size++] = popLsb(pawns) ^ flipSquares;
+        }
+        leadPawnCount = size;
+        swap(squares[0], *max_element(squares, squares + leadPawnCount, pawnOrder));
+        file = min(squares[0] % 8, 7 - squares[0] % 8);
+    }
+
+    if (table.dtz && (table.get(0, file)->flags & FLAG_STM) != stm && (table.key != table.key2 || table.hasPawns)) {
+        state = ProbeState::CHANGE_SIDE;
+        return 0;
+    }
+
+    Bitboard others = bb.getOccupied() ^ leadPawns;
+    while (others) {
+        int pos = popLsb(others);
+        squares[size] = pos ^ flipSquares;
+        pieces[size++] = pieceCode(board.getPiece(pos)) ^ flipColor;
+    }
+
+    // Pieces go in the order the part was indexed with
+    SyzygyPairs* d = table.get(stm, file);
+    for (int i = leadPawnCount; i < size - 1; i++) {
+        for (int j = i + 1; j < size; j++) {
+            if (d->pieces[i] == pieces[j]) {
+                swap(pieces[i], pieces[j]);
+                swap(squares[i], squares[j]);
+                break;
+            }
+        }
+    }
+
+    // The leading piece goes to files a to d
+    if (squares[0] % 8 > 3) {
+        for (int i = 0; i < size; i++) {
+            squares[i] ^= 7;
+        }
+    }
+
+    uint64_t index;
+    if (table.hasPawns) {
+        index = leadPawnIndex[leadPawnCount][squares[0]];
+        stable_sort(squares + 1, squares + leadPawnCount, pawnOrder);
+        for (int i = 1; i < leadPawnCount; i++) {
+            index += binomial[i][mapPawns[squares[i]]];
+        }
+    }
+    else {
+        // Without pawns the leading piece also goes to ranks 1 to 4, and the
+        // first leading piece off the a1-h8 diagonal below it
+        if (squares[0] / 8 > 3) {
+            for (int i = 0; i < size; i++) {
+                squares[i] ^= 56;
+            }
+        }
+        for (int i = 0; i < d->groupLength[0]; i++) {
+            if (!offDiagonal(squares[i])) {
+                continue;
+            }
+            if (offDiagonal(squares[i]) > 0) {
+                for (int j = i; j < size; j++) {
+                    squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+                }
+            }
+            break;
+        }
+
+        if (table.hasUniquePieces) {
+            // The first three pieces together in 31332 ways
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (offDiagonal(squares[0])) {
+                index = ((uint64_t)mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+            }
+            else if (offDiagonal(squares[1])) {
+                index = (6 * 63 + (squares[0] / 8) * 28 + mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+            }
+            else if (offDiagonal(squares[2])) {
+                index = 6 * 63 * 62 + 4 * 28 * 62 + (squares[0] / 8) * 7 * 28 + (squares[1] / 8 - adjust1) * 28 + mapB1H1H7[squares[2]];
+            }
+            else {
+                index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + (squares[0] / 8) * 7 * 6 + (squares[1] / 8 - adjust1) * 6 + (squares[2] / 8 - adjust2);
+            }
+        }
+        else {
+            index = mapKK[mapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+
+    // Each further group of like pieces (or the other side's pawns) counts
+    // the squares left by the groups before it
+    index *= d->groupIndex[0];
+    int* group = squares + d->groupLength[0];
+    bool remainingPawns = table.hasPawns && table.pawnCount[1];
+    for (int next = 1; d->groupLength[next]; next++) {
+        sort(group, group + d->groupLength[next]);
+        uint64_t n = 0;
+        for (int i = 0; i < d->groupLength[next]; i++) {
+            int adjust = (int)count_if(squares, group, [&](int pos) { return group[i] > pos; });
+            n += binomial[i + 1][group[i] - adjust - 8 * remainingPawns];
+        }
+        remainingPawns = false;
+        index += n * d->groupIndex[next];
+        group += d->groupLength[next];
+    }
+
+    int value = decompressPairs(d, index);
+    return (table.dtz) ? mapDtz(table, file, value, wdl) : value - 2;
+}
+
+static int probeTable(const Board& board, bool dtz, ProbeState& state, int wdl = Tablebase::DRAW) {
+    if (popCount(board.getBitboards().getOccupied()) == 2) {
+        return 0; // bare kings
+    }
+    unordered_map<uint64_t, size_t>::const_iterator found = tableIndex.find(materialKey(board));
+    if (found == tableIndex.end()) {
+        state = ProbeState::FAIL;
+        return 0;
+    }
+    SyzygyTable& table = (dtz) ? dtzTables[found->second] : wdlTables[found->second];
+    if (!loadTable(table)) {
+        state = ProbeState::FAIL;
+        return 0;
+    }
+    return readTable(board, table, wdl, state);
+}
+
+// The caller's board, the probes play their moves on it and take them back
+struct ProbeBoard {
+    Board& board;
+    const MoveValidator& validator;
+    MoveExecutor& executor;
+
+    bool isCapture(const Move& move) const {
+        return board.getPiece(move.to).isActive()
+            || (move.to == board.getEnPassantMove() && board.getPiece(move.from).isOfType(PieceType::PAWN));
+    }
+
+    bool isMated() const {
+        PieceSide side = board.getSideToMove();
+        return validator.getGenerator().isInCheck(side) && !validator.getGenerator().hasLegalMoves(side);
+    }
+};
+
+// The WDL of the position, trying captures (and with pawnMoves pawn moves)
+// first. Sets ZEROING_BEST_MOVE when such a move is the best one.
+static int searchZeroing(ProbeBoard& probe, bool pawnMoves, ProbeState& state) {
+    MoveList moves;
+    probe.validator.getLegalMoves(moves);
+    int best = Tablebase::LOSS, moveCount = 0;
+    for (const Move& move : moves) {
+        if (!probe.isCapture(move) && (!pawnMoves || !probe.board.getPiece(move.from).isOfType(PieceType::PAWN))) {
+            continue;
+        }
+        moveCount++;
+        probe.executor.makeMove(move);
+        int value = -searchZeroing(probe, false, state);
+        probe.executor.unmakeMove();
+        if (state == ProbeState::FAIL) {
+            return Tablebase::DRAW;
+        }
+        if (value > best) {
+            best = value;
+            if (value >= Tablebase::WIN) {
+                state = ProbeState::ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+
+    // When every move was searched the table is not needed, and it would
+    // be wrong for a position with an en passant capture
+    bool noMoreMoves = moveCount && moveCount == moves.size();
+    int value = best;
+    if (!noMoreMoves) {
+        value = probeTable(probe.board, false, state);
+        if (state == ProbeState::FAIL) {
+            return Tablebase::DRAW;
+        }
+    }
+    if (best >= value) {
+        state = (best > Tablebase::DRAW || noMoreMoves) ? ProbeState::ZEROING_BEST_MOVE : ProbeState::OK;
+        return best;
+    }
+    state = ProbeState::OK;
+    return value;
+}
+
+// DTZ of the position before a zeroing move with the result after it
+static int dtzBeforeZeroing(int wdl) {
+    return (wdl == Tablebase::WIN) ? 1 : (wdl == Tablebase::CURSED_WIN) ? 101 : (wdl == Tablebase::BLESSED_LOSS) ? -101 : (wdl == Tablebase::LOSS) ? -1 : 0;
+}
+
+static int searchDtz(ProbeBoard& probe, ProbeState& state) {
+    state = ProbeState::OK;
+    int wdl = searchZeroing(probe, true, state);
+    if (state == ProbeState::FAIL || wdl == Tablebase::DRAW) {
+        return 0; // draws are not stored
+    }
+    if (state == ProbeState::ZEROING_BEST_MOVE) {
+        return dtzBeforeZeroing(wdl);
+    }
+    int dtz = probeTable(probe.board, true, state, wdl);
+    if (state == ProbeState::FAIL) {
+        return 0;
+    }
+    if (state != ProbeState::CHANGE_SIDE) {
+        return (dtz + 100 * (wdl == Tablebase::BLESSED_LOSS || wdl == Tablebase::CURSED_WIN)) * signOf(wdl);
+    }
+
+    // Only the other side to move is stored, so take the best move's DTZ
+    MoveList moves;
+    probe.validator.getLegalMoves(moves);
+    int minDtz = 0xFFFF;
+    for (const Move& move : moves) {
+        bool zeroing = probe.isCapture(move) || probe.board.getPiece(move.from).isOfType(PieceType::PAWN);
+        probe.executor.makeMove(move);
+        dtz = (zeroing) ? -dtzBeforeZeroing(searchZeroing(probe, false, state)) : -searchDtz(probe, state);
+        if (dtz == 1 && probe.isMated()) {
+            minDtz = 1;
+        }
+        if (!zeroing) {
+            dtz += signOf(dtz);
+        }
+        if (dtz < minDtz && signOf(dtz) == signOf(wdl)) {
+            minDtz = dtz;
+        }
+        probe.executor.unmakeMove();
+        if (state == ProbeState::FAIL) {
+            return 0;
+        }
+    }
+    return (minDtz == 0xFFFF) ? -1 : minDtz;
+}
+
+static bool isCovered(const Board& board) {
+    return maxPieces && !board.getCastlingRights() && popCount(board.getBitboards().getOccupied()) <= maxPieces;
+}
+
+// Every material from KvK up, each side's pieces strongest first. The side
+// with more pieces, or the stronger pieces, is named first.
+static void addTables(vector<int>& first, vector<int>& second) {
+    if (first.size() + second.size() + 2 > Tablebase::MAX_PIECES) {
+        return;
+    }
+    if (!first.empty() && (first.size() > second.size() || (first.size() == second.size() && first >= second))) {
+        const char letters[] = " PNBRQK";
+        string name = "K";
+        for (int type : first) {
+            name += letters[type];
+        }
+        name += "vK";
+        for (int type : second) {
+            name += letters[type];
+        }
+        SyzygyTable probe(name, false);
+        size_t size;
+        if (openTable(probe, size)) {
+            closeTable(probe);
+            wdlTables.emplace_back(name, false);
+            dtzTables.emplace_back(name, true);
+            initTableInfo(wdlTables.back());
+            initTableInfo(dtzTables.back());
+            tableIndex[wdlTables.back().key] = wdlTables.size() - 1;
+            tableIndex[wdlTables.back().key2] = wdlTables.size() - 1;
+            maxPieces = max(maxPieces, wdlTables.back().pieceCount);
+        }
+    }
+}
+
+// Adds tables with the given first side for every second side
+static void enumerateSecond(vector<int>& first, vector<int>& second) {
+    addTables(first, second);
+    if (first.size() + second.size() + 2 >= Tablebase::MAX_PIECES) {
+        return;
+    }
+    int strongest = (second.empty()) ? (int)PieceType::QUEEN : second.back();
+    for (int type = strongest; type >= (int)PieceType::PAWN; type--) {
+        second.push_back(type);
+        enumerateSecond(first, second);
+        second.pop_back();
+    }
+}
+
+static void enumerateFirst(vector<int>& first, vector<int>& second) {
+    enumerateSecond(first, second);
+    if (first.size() + 2 >= Tablebase::MAX_PIECES) {
+        return;
+    }
+    int strongest = (first.empty()) ? (int)PieceType::QUEEN : first.back();
+    for (int type = strongest; type >= (int)PieceType::PAWN; type--) {
+        first.push_back(type);
+        enumerateFirst(first, second);
+        first.pop_back();
+    }
+}
+
+int Tablebase::setPaths(const string& paths) {
+    call_once(indexTablesFlag, buildIndexTables);
+    lock_guard<mutex> guard(loadLock);
+    for (SyzygyTable& table : wdlTables) {
+        closeTable(table);
+    }
+    for (SyzygyTable& table : dtzTables) {
+        closeTable(table);
+    }
+    wdlTables.clear();
+    dtzTables.clear();
+    tableIndex.clear();
+    maxPieces = 0;
+    searchPaths = paths;
+    if (!paths.empty()) {
+        vector<int> first, second;
+        enumerateFirst(first, second);
+    }
+    return (int)wdlTables.size();
+}
+
+int Tablebase::getMaxPieces() {
+    return maxPieces;
+}
+
+bool Tablebase::probeWdl(Board& board, const MoveValidator& validator, MoveExecutor& executor, int& wdl) {
+    if (!isCovered(board)) {
+        return false;
+    }
+    ProbeBoard probe{ board, validator, executor };
+    ProbeState state = ProbeState::OK;
+    wdl = searchZeroing(probe, false, state);
+    return state != ProbeState::FAIL;
+}
+
+bool Tablebase::probeDtz(Board& board, const MoveValidator& validator, MoveExecutor& executor, int& dtz) {
+    if (!isCovered(board)) {
+        return false;
+    }
+    ProbeBoard probe{ board, validator, executor };
+    ProbeState state;
+    dtz = searchDtz(probe, state);
+    return state != ProbeState::FAIL;
+}
+
+bool Tablebase::rankRootMoves(Board& board, const MoveValidator& validator, MoveExecutor& executor, const MoveList& moves, int ranks[]) {
+    if (!isCovered(board)) {
+        return false;
+    }
+    ProbeBoard probe{ board, validator, executor };
+    int halfmoves = board.getHalfmoveClock();
+    for (int i = 0; i < moves.size(); i++) {
+        ProbeState state = ProbeState::OK;
+        probe.executor.makeMove(moves[i]);
+        int dtz;
+        if (probe.board.getHalfmoveClock() == 0) {
+            dtz = dtzBeforeZeroing(-searchZeroing(probe, false, state));
+        }
+        else {
+            dtz = -searchDtz(probe, state);
+            dtz += signOf(dtz);
+        }
+        if (dtz == 2 && probe.isMated()) {
+            dtz = 1;
+        }
+        probe.executor.unmakeMove();
+        if (state == ProbeState::FAIL) {
+            return false;
+        }
+
+        // Wins the fifty move rule cannot spoil rank by speed, others by how
+        // close they stay to the limit. Losses mirror this.
+        if (dtz > 0) {
+            ranks[i] = (dtz + halfmoves <= 99) ? 2 * CERTAIN_RANK - dtz : max(1, CERTAIN_RANK - (dtz + halfmoves));
+        }
+        else if (dtz < 0) {
+            ranks[i] = (-dtz + halfmoves <= 100) ? -2 * CERTAIN_RANK - dtz : min(-1, -CERTAIN_RANK + (-dtz + halfmoves));
+        }
+        else {
+            ranks[i] = 0;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../board/Board.h"
+#include "../moves/MoveList.h"
+#include "../moves/MoveExecutor.h"
+#include <string>
+
+using namespace std;
+
+// Syzygy endgame tablebases of up to seven pieces. setPaths looks for the
+// .rtbw (win, draw or loss) file of every material, and a file and its
+// .rtbz (distance to zeroing) partner are mapped on the first probe of
+// their material and stay mapped.
+//
+// The files follow the published Syzygy format. A table may hold any value
+// for positions where a capture is best, so captures are searched before a
+// table is read, as the reference probing code does. Positions with
+// castling rights are not covered. The probes play their moves on the
+// caller's board and take them back before returning.
+class Tablebase {
+public:
+    static constexpr int MAX_PIECES = 7;
+
+    // Results for the side to move. A cursed win or blessed loss becomes a
+    // draw under the fifty move rule.
+    static constexpr int LOSS = -2;
+    static constexpr int BLESSED_LOSS = -1;
+    static constexpr int DRAW = 0;
+    static constexpr int CURSED_WIN = 1;
+    static constexpr int WIN = 2;
+
+    // Root move ranks above this win and below minus this lose, fifty move rule included
+    static constexpr int CERTAIN_RANK = 1000;
+
+    // Directories separated by ':' (';' on Windows), empty turns probing off.
+    // Returns the number of tables found. Only call while no search runs.
+    static int setPaths(const string& paths);
+
+    // Most pieces in any table found, 0 without tables
+    static int getMaxPieces();
+
+    // Result for the side to move, false if the position is not covered
+    static bool probeWdl(Board& board, const MoveValidator& validator, MoveExecutor& executor, int& wdl);
+
+    // Plies to the next capture or pawn move with best play, positive when
+    // the side to move wins and -1 when it is mated. Beyond 100 the fifty
+    // move rule draws. The value may be one ply short unless the position
+    // follows a capture or pawn move. False if the position is not covered.
+    static bool probeDtz(Board& board, const MoveValidator& validator, MoveExecutor& executor, int& dtz);
+
+    // Ranks every move by result and distance to zeroing from the current
+    // halfmove clock. Higher is better: quicker wins, slower losses. False
+    // if a move is not covered.
+    static bool rankRootMoves(Board& board, const MoveValidator& validator, MoveExecutor& executor, const MoveList& moves, int ranks[]);
+};
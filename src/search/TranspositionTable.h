@@ -0,0 +1,147 @@
+#pragma once
+
+#include "../moves/Move.h"
+#include "../constants/Enums.h"
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+// What a probe returns for a position that was stored before
+struct TTEntry {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Probe counts kept by each searching thread and summed when reported, so
+// the threads never write to a shared counter
+struct TTStats {
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    uint64_t collisions = 0; // the slot held another position
+
+    TTStats& operator+=(const TTStats& other) {
+        probes += other.probes;
+        hits += other.hits;
+        collisions += other.collisions;
+        return *this;
+    }
+};
+
+// Fixed-size hash table of search results keyed by Zobrist hash, shared by
+// every search thread without locks. Each slot is 16 bytes: the packed data
+// and the key XOR the data. A slot torn by two threads writing at once no
+// longer verifies, so it reads as a miss instead of returning wrong data.
+class TranspositionTable {
+private:
+    struct Slot {
+        atomic<uint64_t> check; // key ^ data
+        atomic<uint64_t> data;
+    };
+    static_assert(sizeof(Slot) == 16, "Transposition table slots must stay 16 bytes");
+
+    unique_ptr<Slot[]> slots;
+    uint64_t mask; // slot count - 1, the count is a power of two
+    uint8_t generation;
+
+    // Data layout: move 16 bits, score 16, depth 8, bound 2, generation 6
+    static uint64_t pack(const Move& move, int score, int depth, Bound bound, uint8_t generation) {
+        uint64_t moveBits = (move.isValid()) ? (uint64_t)(move.from | (move.to << 6) | ((int)move.promotion << 12)) : 0;
+        return moveBits
+            | ((uint64_t)(uint16_t)(int16_t)score << 16)
+            | ((uint64_t)(uint8_t)depth << 32)
+            | ((uint64_t)bound << 40)
+            | ((uint64_t)(generation & 63) << 42);
+    }
+
+    static TTEntry unpack(uint64_t data) {
+        TTEntry entry;
+        int moveBits = data & 0xFFFF;
+        entry.move = (moveBits) ? Move(moveBits & 63, (moveBits >> 6) & 63, (PieceType)((moveBits >> 12) & 7)) : Move();
+        entry.score = (int16_t)(data >> 16);
+        entry.depth = (int8_t)(data >> 32);
+        entry.bound = (Bound)((data >> 40) & 3);
+        return entry;
+    }
+
+    static uint8_t generationOf(uint64_t data) { return (data >> 42) & 63; }
+    static int depthOf(uint64_t data) { return (int8_t)(data >> 32); }
+
+    Slot& slotFor(uint64_t key) const { return slots[key & mask]; }
+
+public:
+    // Size is rounded down to a power of two number of slots
+    TranspositionTable(size_t megabytes) : mask(0), generation(0) {
+        resize(megabytes);
+    }
+
+    // Not safe while other threads use the table
+    void resize(size_t megabytes) {
+        size_t count = 1;
+        while (count * 2 * sizeof(Slot) <= megabytes * 1024 * 1024) {
+            count *= 2;
+        }
+        slots.reset(new Slot[count]);
+        mask = count - 1;
+        clear();
+    }
+
+    void clear() {
+        for (uint64_t i = 0; i <= mask; i++) {
+            slots[i].check.store(0, memory_order_relaxed);
+            slots[i].data.store(0, memory_order_relaxed);
+        }
+        generation = 0;
+    }
+
+    // Called once per search so entries from older searches are replaced first
+    void newSearch() {
+        generation = (generation + 1) & 63;
+    }
+
+    // Counts the probe in the caller's stats
+    bool probe(uint64_t key, TTEntry& out, TTStats& stats) const {
+        Slot& slot = slotFor(key);
+        uint64_t data = slot.data.load(memory_order_relaxed);
+        uint64_t check = slot.check.load(memory_order_relaxed);
+        stats.probes++;
+        if ((check ^ data) == key && data) {
+            stats.hits++;
+            out = unpack(data);
+            return true;
+        }
+        stats.collisions += (data != 0);
+        return false;
+    }
+
+    // Keeps a deeper result for the same position from this search, otherwise replaces the slot
+    void store(uint64_t key, const Move& move, int score, int depth, Bound bound) {
+        Slot& slot = slotFor(key);
+        uint64_t oldData = slot.data.load(memory_order_relaxed);
+        bool samePosition = (slot.check.load(memory_order_relaxed) ^ oldData) == key;
+        if (samePosition && generationOf(oldData) == generation && depthOf(oldData) > depth && bound != Bound::EXACT) {
+            return;
+        }
+        // Keep the old best move when this result has none
+        Move storedMove = (!move.isValid() && samePosition) ? unpack(oldData).move : move;
+        uint64_t data = pack(storedMove, score, depth, bound, generation);
+        slot.check.store(key ^ data, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+
+    uint64_t getSlotCount() const { return mask + 1; }
+
+    // Used slots per thousand, sampled from the start of the table
+    int getFullness() const {
+        uint64_t sample = (mask + 1 < 1000) ? mask + 1 : 1000;
+        uint64_t used = 0;
+        for (uint64_t i = 0; i < sample; i++) {
+            uint64_t data = slots[i].data.load(memory_order_relaxed);
+            used += (data && generationOf(data) == generation);
+        }
+        return (int)(used * 1000 / sample);
+    }
+};
@@ -0,0 +1,56 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+atomic<long long> allocationCount(0);
+
+static void* countedAllocate(size_t size) noexcept {
+    allocationCount++;
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    if (void* p = countedAllocate(size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    if (void* p = countedAllocate(size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+    free(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept {
+    free(p);
+}
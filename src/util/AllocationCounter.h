@@ -0,0 +1,10 @@
+#pragma once
+
+#include <atomic>
+
+using namespace std;
+
+// Every heap allocation made by a program that links AllocationCounter.cpp,
+// which replaces the global operator new and delete. The operators live in
+// their own file so callers never see new and delete inlined as malloc and free.
+extern atomic<long long> allocationCount;
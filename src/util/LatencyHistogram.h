@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+using namespace std;
+
+// Counts durations in buckets of about 12% width, so percentiles of any
+// number of samples are read from a fixed 4 KB table.
+class LatencyHistogram {
+private:
+    static const int SUB_BUCKETS = 8; // per power of two
+    static const int BUCKET_COUNT = 64 * SUB_BUCKETS;
+
+    long long counts[BUCKET_COUNT];
+    long long total;
+
+    static int bucketOf(uint64_t nanoseconds) {
+        if (nanoseconds < SUB_BUCKETS) {
+            return (int)nanoseconds;
+        }
+        int exponent = 63 - __builtin_clzll(nanoseconds);
+        int fraction = (int)(nanoseconds >> (exponent - 3)) & (SUB_BUCKETS - 1);
+        return (exponent - 2) * SUB_BUCKETS + fraction;
+    }
+
+    // Largest duration that falls in a bucket
+    static uint64_t upperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return bucket;
+        }
+        int exponent = bucket / SUB_BUCKETS + 2;
+        uint64_t fraction = bucket % SUB_BUCKETS;
+        return ((SUB_BUCKETS + fraction + 1) << (exponent - 3)) - 1;
+    }
+
+public:
+    LatencyHistogram() {
+        clear();
+    }
+
+    void clear() {
+        for (long long& count : counts) {
+            count = 0;
+        }
+        total = 0;
+    }
+
+    void add(uint64_t nanoseconds) {
+        counts[bucketOf(nanoseconds)]++;
+        total++;
+    }
+
+    // Duration in nanoseconds that the given fraction of samples do not exceed
+    uint64_t percentile(double fraction) const {
+        long long rank = (long long)(fraction * total);
+        long long seen = 0;
+        for (int bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+            seen += counts[bucket];
+            if (seen > rank || seen == total) {
+                return upperBound(bucket);
+            }
+        }
+        return 0;
+    }
+
+    long long getCount() const { return total; }
+};
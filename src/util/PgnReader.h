@@ -0,0 +1,222 @@
+#pragma once
+
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+enum class PgnTokenType {
+    TAG,    // [Name "value"]
+    MOVE,   // a move in standard algebraic notation
+    RESULT, // 1-0, 0-1, 1/2-1/2 or *, ends the movetext of a game
+    END
+};
+
+// One token with where it starts in the file. Text longer than the
+// buffers is cut short, so a token never needs more memory.
+struct PgnToken {
+    static const int MAX_TEXT = 256;
+
+    PgnTokenType type = PgnTokenType::END;
+    char name[MAX_TEXT]; // tag name, or the move or result text
+    char value[MAX_TEXT]; // tag value
+    int nameLength = 0, valueLength = 0;
+    long long line = 0, column = 0;
+};
+
+// Splits a PGN file into tags, moves and results. The file is read through
+// one fixed buffer; comments, variations, move numbers and annotation
+// glyphs are skipped as they stream past, so memory stays the same
+// whatever the size of the file.
+class PgnReader {
+private:
+    static const int BUFFER_SIZE = 1 << 20;
+
+    ifstream file;
+    char* buffer;
+    int bufferLength, bufferPos;
+    long long bytesRead;
+    long long line, column;
+
+    // Next character or EOF, refilling the buffer when it runs out
+    int peek() {
+        if (bufferPos == bufferLength) {
+            file.read(buffer, BUFFER_SIZE);
+            bufferLength = (int)file.gcount();
+            bufferPos = 0;
+            bytesRead += bufferLength;
+            if (bufferLength == 0) {
+                return EOF;
+            }
+        }
+        return (unsigned char)buffer[bufferPos];
+    }
+
+    int next() {
+        int c = peek();
+        if (c != EOF) {
+            bufferPos++;
+            column++;
+            if (c == '\n') {
+                line++;
+                column = 0;
+            }
+        }
+        return c;
+    }
+
+    static bool isSymbolChar(int c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+            || c == '_' || c == '+' || c == '#' || c == '=' || c == ':' || c == '-' || c == '/' || c == '!' || c == '?';
+    }
+
+    static void append(char* text, int& length, int c) {
+        if (length < PgnToken::MAX_TEXT - 1) {
+            text[length++] = (char)c;
+        }
+        text[length] = '\0';
+    }
+
+    void skipLine() {
+        for (int c = next(); c != EOF && c != '\n'; c = next()) {}
+    }
+
+    void skipComment() {
+        for (int c = next(); c != EOF && c != '}'; c = next()) {}
+    }
+
+    // Variations nest and may hold comments with unbalanced parentheses
+    void skipVariation() {
+        int depth = 1;
+        while (depth > 0) {
+            int c = next();
+            if (c == EOF) {
+                return;
+            }
+            if (c == '(') {
+                depth++;
+            }
+            else if (c == ')') {
+                depth--;
+            }
+            else if (c == '{') {
+                skipComment();
+            }
+            else if (c == ';') {
+                skipLine();
+            }
+        }
+    }
+
+    void readTag(PgnToken& token) {
+        token.type = PgnTokenType::TAG;
+        while (peek() == ' ' || peek() == '\t') {
+            next();
+        }
+        while (isSymbolChar(peek())) {
+            append(token.name, token.nameLength, next());
+        }
+        while (peek() != EOF && peek() != '"' && peek() != ']') {
+            next();
+        }
+        if (peek() == '"') {
+            next();
+            for (int c = next(); c != EOF && c != '"'; c = next()) {
+                if (c == '\\') {
+                    c = next();
+                }
+                append(token.value, token.valueLength, c);
+            }
+        }
+        while (peek() != EOF && peek() != ']' && peek() != '\n') {
+            next();
+        }
+        if (peek() == ']') {
+            next();
+        }
+    }
+
+    static bool isResult(const char* text) {
+        return strcmp(text, "1-0") == 0 || strcmp(text, "0-1") == 0 || strcmp(text, "1/2-1/2") == 0 || strcmp(text, "*") == 0;
+    }
+
+public:
+    PgnReader(const char* path) : file(path, ios::binary), buffer(new char[BUFFER_SIZE]) {
+        bufferLength = bufferPos = 0;
+        bytesRead = 0;
+        line = 1;
+        column = 0;
+    }
+
+    ~PgnReader() {
+        delete[] buffer;
+    }
+
+    PgnReader(const PgnReader&) = delete;
+    PgnReader& operator=(const PgnReader&) = delete;
+
+    bool isOpen() const { return file.is_open(); }
+    long long getBytesRead() const { return bytesRead; }
+
+    // Reads the next token, an END token once the file is exhausted
+    void nextToken(PgnToken& token) {
+        for (;;) {
+            token.nameLength = token.valueLength = 0;
+            token.name[0] = token.value[0] = '\0';
+            token.line = line;
+            token.column = column + 1;
+            int c = next();
+            if (c == EOF) {
+                token.type = PgnTokenType::END;
+                return;
+            }
+            if (c == '%' && column == 1) {
+                skipLine(); // escape line
+            }
+            else if (c == ';') {
+                skipLine();
+            }
+            else if (c == '{') {
+                skipComment();
+            }
+            else if (c == '(') {
+                skipVariation();
+            }
+            else if (c == '$') {
+                while (peek() >= '0' && peek() <= '9') {
+                    next();
+                }
+            }
+            else if (c == '[') {
+                readTag(token);
+                return;
+            }
+            else if (c == '*') {
+                token.type = PgnTokenType::RESULT;
+                append(token.name, token.nameLength, c);
+                return;
+            }
+            else if (isSymbolChar(c)) {
+                append(token.name, token.nameLength, c);
+                while (isSymbolChar(peek())) {
+                    append(token.name, token.nameLength, next());
+                }
+                if (isResult(token.name)) {
+                    token.type = PgnTokenType::RESULT;
+                    return;
+                }
+                // A move number is digits followed by dots
+                bool number = true;
+                for (int i = 0; i < token.nameLength && number; i++) {
+                    number = token.name[i] >= '0' && token.name[i] <= '9';
+                }
+                if (!number) {
+                    token.type = PgnTokenType::MOVE;
+                    return;
+                }
+            }
+            // Whitespace, dots and anything unknown are passed over
+        }
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads, each with its own task deque. A worker takes
+// its newest task first and, when it runs dry, steals the oldest task of
+// another worker, so uneven tasks even out without a central queue.
+class WorkStealingPool {
+public:
+    typedef function<void(int worker)> Task;
+
+    // Per worker counters, only written by that worker
+    struct WorkerStats {
+        long long executed = 0;
+        long long stolen = 0;
+    };
+
+private:
+    struct Worker {
+        mutex lock;
+        deque<Task> tasks;
+        WorkerStats stats;
+        thread runner;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    atomic<bool> stopping;
+    atomic<long long> queued;  // submitted and not yet taken
+    atomic<long long> pending; // submitted and not yet finished
+    atomic<int> nextWorker;
+    mutex idleLock;
+    condition_variable workAvailable;
+    condition_variable allDone;
+
+    bool popOwn(int index, Task& task) {
+        Worker& worker = *workers[index];
+        lock_guard<mutex> guard(worker.lock);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        task = move(worker.tasks.back());
+        worker.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int index, Task& task) {
+        for (size_t offset = 1; offset < workers.size(); offset++) {
+            Worker& victim = *workers[(index + offset) % workers.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(int index) {
+        Task task;
+        while (true) {
+            bool stole = false;
+            bool found = popOwn(index, task) || (stole = steal(index, task));
+            if (!found) {
+                unique_lock<mutex> guard(idleLock);
+                workAvailable.wait(guard, [this]() { return stopping || queued > 0; });
+                if (stopping && queued == 0) {
+                    return;
+                }
+                continue;
+            }
+            queued--;
+            task(index);
+            task = nullptr;
+            workers[index]->stats.executed++;
+            workers[index]->stats.stolen += stole;
+            if (--pending == 0) {
+                lock_guard<mutex> guard(idleLock);
+                allDone.notify_all();
+            }
+        }
+    }
+
+public:
+    WorkStealingPool(int threadCount) : stopping(false), queued(0), pending(0), nextWorker(0) {
+        threadCount = max(threadCount, 1);
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back(new Worker());
+        }
+        for (int i = 0; i < threadCount; i++) {
+            workers[i]->runner = thread(&WorkStealingPool::workerLoop, this, i);
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            lock_guard<mutex> guard(idleLock);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for (unique_ptr<Worker>& worker : workers) {
+            worker->runner.join();
+        }
+    }
+
+    // Tasks are dealt to the workers in turn
+    void submit(Task task) {
+        pending++;
+        Worker& worker = *workers[nextWorker++ % workers.size()];
+        {
+            lock_guard<mutex> guard(worker.lock);
+            worker.tasks.push_back(move(task));
+        }
+        {
+            lock_guard<mutex> guard(idleLock);
+            queued++;
+        }
+        workAvailable.notify_one();
+    }
+
+    // Blocks until every submitted task has finished
+    void waitIdle() {
+        unique_lock<mutex> guard(idleLock);
+        allDone.wait(guard, [this]() { return pending == 0; });
+    }
+
+    int getThreadCount() const { return (int)workers.size(); }
+
+    // Only consistent while the pool is idle
+    const WorkerStats& getStats(int worker) const { return workers[worker]->stats; }
+
+    void resetStats() {
+        for (unique_ptr<Worker>& worker : workers) {
+            worker->stats = WorkerStats();
+        }
+    }
+};